@@ -1,4 +1,4 @@
-%global mod_ver 0.7.3
+%global mod_ver 0.8
 
 %{?_datarootdir: %global mydatarootdir %_datarootdir}
 %{!?_datarootdir: %global mydatarootdir /usr/share}
@@ -114,6 +114,9 @@ qore -l ./yaml-api-%{module_api}.qmod test/YamlRpcHandler.qtest -v
 qore -l ./yaml-api-%{module_api}.qmod test/yaml.qtest -v
 
 %changelog
+* Fri Oct 16 2026 David Nichols <david@qore.org> 0.8
+- updated to version 0.8
+
 * Mon Dec 19 2022 David Nichols <david@qore.org> 0.7.3
 - updated to version 0.7.3
 
@@ -0,0 +1,85 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/*
+    QC_YamlDocumentReader.h
+
+    Qore Programming Language
+
+    Copyright 2003 - 2022 Qore Technologies, s.r.o.
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef _QORE_YAML_QC_YAMLDOCUMENTREADER_H
+#define _QORE_YAML_QC_YAMLDOCUMENTREADER_H
+
+#include "yaml-module.h"
+
+DLLLOCAL extern qore_classid_t CID_YAMLDOCUMENTREADER;
+DLLLOCAL extern QoreClass* QC_YAMLDOCUMENTREADER;
+
+DLLLOCAL QoreClass* initYamlDocumentReaderClass(QoreNamespace& ns);
+
+//! private data for the YamlDocumentReader class; parses one document at a time from an InputStream
+class QoreYamlDocumentReader : public AbstractPrivateData {
+public:
+    //! the InputStream must be already referenced for the new object
+    DLLLOCAL QoreYamlDocumentReader(InputStream* is, ExceptionSink* xsink) : rh(is, xsink), parser(rh, xsink) {
+    }
+
+    DLLLOCAL virtual void deref(ExceptionSink* xsink) {
+        if (ROdereference()) {
+            doc.discard(xsink);
+            rh.deref(xsink);
+            delete this;
+        }
+    }
+
+    //! parses the next document; returns false at the end of the stream or if an exception was raised
+    DLLLOCAL bool next(ExceptionSink* xsink) {
+        AutoLocker al(m);
+        rh.setExceptionSink(xsink);
+        parser.setExceptionSink(xsink);
+
+        doc.discard(xsink);
+        doc.clear();
+        have_doc = parser.parseNextDocument(doc);
+        return have_doc;
+    }
+
+    DLLLOCAL QoreValue getValue(ExceptionSink* xsink) {
+        AutoLocker al(m);
+        if (!have_doc) {
+            xsink->raiseException("INVALID-ITERATOR", "the YamlDocumentReader is not pointing at a valid document; "
+                "make sure YamlDocumentReader::next() returns True before calling this method");
+            return QoreValue();
+        }
+        return doc.refSelf();
+    }
+
+    DLLLOCAL bool valid() {
+        AutoLocker al(m);
+        return have_doc;
+    }
+
+protected:
+    QoreThreadLock m;
+    QoreYamlInputStreamReadHandler rh;
+    QoreYamlParser parser;
+    // the current document
+    QoreValue doc;
+    bool have_doc = false;
+};
+
+#endif
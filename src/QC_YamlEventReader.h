@@ -0,0 +1,83 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/*
+    QC_YamlEventReader.h
+
+    Qore Programming Language
+
+    Copyright 2003 - 2022 Qore Technologies, s.r.o.
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef _QORE_YAML_QC_YAMLEVENTREADER_H
+#define _QORE_YAML_QC_YAMLEVENTREADER_H
+
+#include "yaml-module.h"
+
+#include <memory>
+
+DLLLOCAL extern qore_classid_t CID_YAMLEVENTREADER;
+DLLLOCAL extern QoreClass* QC_YAMLEVENTREADER;
+
+DLLLOCAL QoreClass* initYamlEventReaderClass(QoreNamespace& ns);
+
+//! private data for the YamlEventReader class; returns one parser event at a time
+class QoreYamlEventReader : public AbstractPrivateData {
+public:
+    //! parses the given UTF-8 string; the string must be already referenced for the new object
+    DLLLOCAL QoreYamlEventReader(QoreStringNode* str, ExceptionSink* xsink) : str(str),
+            parser(new QoreYamlParser(*str, xsink)) {
+        parser->setUnknownTagsAsStrings();
+    }
+
+    //! parses data from the given InputStream; the InputStream must be already referenced for the new object
+    DLLLOCAL QoreYamlEventReader(InputStream* is, ExceptionSink* xsink) : rh(new QoreYamlInputStreamReadHandler(is,
+            xsink)), parser(new QoreYamlParser(*rh, xsink)) {
+        parser->setUnknownTagsAsStrings();
+    }
+
+    DLLLOCAL virtual void deref(ExceptionSink* xsink) {
+        if (ROdereference()) {
+            parser.reset();
+            if (rh) {
+                rh->deref(xsink);
+            }
+            if (str) {
+                str->deref();
+            }
+            delete this;
+        }
+    }
+
+    //! returns the next event or nullptr at the end of the stream or if an exception was raised
+    DLLLOCAL QoreHashNode* next(ExceptionSink* xsink) {
+        AutoLocker al(m);
+        if (rh) {
+            rh->setExceptionSink(xsink);
+        }
+        parser->setExceptionSink(xsink);
+        return parser->parseEvent();
+    }
+
+protected:
+    QoreThreadLock m;
+    // the string being parsed, if any
+    QoreStringNode* str = nullptr;
+    // the read handler for the InputStream, if any
+    std::unique_ptr<QoreYamlInputStreamReadHandler> rh;
+    std::unique_ptr<QoreYamlParser> parser;
+};
+
+#endif
@@ -0,0 +1,121 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/*
+    QC_YamlPushParser.h
+
+    Qore Programming Language
+
+    Copyright 2003 - 2022 Qore Technologies, s.r.o.
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef _QORE_YAML_QC_YAMLPUSHPARSER_H
+#define _QORE_YAML_QC_YAMLPUSHPARSER_H
+
+#include "yaml-module.h"
+
+DLLLOCAL extern qore_classid_t CID_YAMLPUSHPARSER;
+DLLLOCAL extern QoreClass* QC_YAMLPUSHPARSER;
+
+DLLLOCAL QoreClass* initYamlPushParserClass(QoreNamespace& ns);
+
+//! private data for the YamlPushParser class; parses input as it is received
+/** complete documents or root sequence elements are parsed as soon as the start of the next one has been received
+*/
+class QoreYamlPushParser : public AbstractPrivateData {
+public:
+    //! the options must be already referenced for the new object
+    DLLLOCAL QoreYamlPushParser(bool elements, QoreHashNode* opts) : splitter(elements), elements(elements),
+            opts(opts) {
+        if (opts) {
+            QoreValue v = opts->getKeyValue("max_bytes");
+            if (v.getType() == NT_INT) {
+                max_bytes = (size_t)v.getAsBigInt();
+            }
+        }
+    }
+
+    DLLLOCAL virtual void deref(ExceptionSink* xsink) {
+        if (ROdereference()) {
+            clearAnchors(xsink);
+            if (opts) {
+                opts->deref(xsink);
+            }
+            delete this;
+        }
+    }
+
+    //! adds UTF-8 encoded input and returns the values completed by it
+    DLLLOCAL QoreListNode* feed(const void* data, size_t len, ExceptionSink* xsink) {
+        AutoLocker al(m);
+        if (checkFinished(xsink)) {
+            return nullptr;
+        }
+        buf.append((const char*)data, len);
+        return parse(false, xsink);
+    }
+
+    //! signals the end of the input and returns the remaining values
+    DLLLOCAL QoreListNode* finish(ExceptionSink* xsink) {
+        AutoLocker al(m);
+        if (checkFinished(xsink)) {
+            return nullptr;
+        }
+        finished = true;
+        return parse(true, xsink);
+    }
+
+protected:
+    QoreThreadLock m;
+    // input received but not yet parsed
+    std::string buf;
+    QoreYamlSplitter splitter;
+    // return root sequence elements instead of documents
+    bool elements;
+    // parse options
+    QoreHashNode* opts;
+    // the maximum size of the unparsed input; 0 = no limit
+    size_t max_bytes = 0;
+    // anchors of the current document when returning root sequence elements
+    anchor_value_map_t anchors;
+    // a unit that could not be parsed and is merged with the following input
+    bool pending = false;
+    size_t pending_start = 0;
+    std::string pending_prefix;
+    bool pending_doc_start = false;
+    // the start of the input has been checked
+    bool checked = false;
+    // finish() has been called
+    bool finished = false;
+
+    DLLLOCAL int checkFinished(ExceptionSink* xsink) {
+        if (finished) {
+            xsink->raiseException("YAMLPUSHPARSER-ERROR", "YamlPushParser::finish() has already been called");
+            return -1;
+        }
+        return 0;
+    }
+
+    DLLLOCAL void clearAnchors(ExceptionSink* xsink) {
+        for (auto& i : anchors) {
+            i.second.discard(xsink);
+        }
+        anchors.clear();
+    }
+
+    DLLLOCAL QoreListNode* parse(bool final, ExceptionSink* xsink);
+};
+
+#endif
@@ -0,0 +1,124 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/*
+    QC_YamlStreamWriter.h
+
+    Qore Programming Language
+
+    Copyright 2003 - 2022 Qore Technologies, s.r.o.
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef _QORE_YAML_QC_YAMLSTREAMWRITER_H
+#define _QORE_YAML_QC_YAMLSTREAMWRITER_H
+
+#include "yaml-module.h"
+
+#include <memory>
+#include <vector>
+
+DLLLOCAL extern qore_classid_t CID_YAMLSTREAMWRITER;
+DLLLOCAL extern QoreClass* QC_YAMLSTREAMWRITER;
+
+DLLLOCAL QoreClass* initYamlStreamWriterClass(QoreNamespace& ns);
+
+//! private data for the YamlStreamWriter class; writes YAML output one node at a time
+class QoreYamlStreamWriter : public AbstractPrivateData {
+public:
+    //! writes output to a string
+    DLLLOCAL QoreYamlStreamWriter(int flags, int width, int indent, ExceptionSink* xsink)
+            : sh(new QoreYamlStringWriteHandler), emitter(new QoreYamlEmitter(*sh, flags, width, indent, xsink)) {
+    }
+
+    //! writes output to the given OutputStream; the OutputStream must be already referenced for the new object
+    DLLLOCAL QoreYamlStreamWriter(OutputStream* os, int flags, int width, int indent, ExceptionSink* xsink)
+            : os(os), oh(new QoreYamlOutputStreamWriteHandler(os, xsink)),
+            emitter(new QoreYamlEmitter(*oh, flags, width, indent, xsink)) {
+    }
+
+    DLLLOCAL virtual void deref(ExceptionSink* xsink) {
+        if (ROdereference()) {
+            // output that has not been completed with close() is discarded
+            if (!closed) {
+                emitter->abandon();
+            }
+            emitter.reset();
+            if (os) {
+                os->deref(xsink);
+            }
+            delete this;
+        }
+    }
+
+    //! starts a list; returns 0 for OK, -1 if an exception was raised
+    DLLLOCAL int beginList(ExceptionSink* xsink);
+
+    //! starts a hash; returns 0 for OK, -1 if an exception was raised
+    DLLLOCAL int beginHash(ExceptionSink* xsink);
+
+    //! writes the key of the next value in the current hash; returns 0 for OK, -1 if an exception was raised
+    DLLLOCAL int key(const QoreString& k, ExceptionSink* xsink);
+
+    //! writes a complete value; returns 0 for OK, -1 if an exception was raised
+    DLLLOCAL int value(const QoreValue& v, ExceptionSink* xsink);
+
+    //! ends the current list or hash; returns 0 for OK, -1 if an exception was raised
+    DLLLOCAL int end(ExceptionSink* xsink);
+
+    //! ends the current document and starts a new one; returns 0 for OK, -1 if an exception was raised
+    DLLLOCAL int newDocument(ExceptionSink* xsink);
+
+    //! completes the output and returns the YAML string if the output is not written to an OutputStream
+    DLLLOCAL QoreStringNode* close(ExceptionSink* xsink);
+
+protected:
+    QoreThreadLock m;
+    // the output stream, if any
+    OutputStream* os = nullptr;
+    // the write handler for string output
+    std::unique_ptr<QoreYamlStringWriteHandler> sh;
+    // the write handler for OutputStream output
+    std::unique_ptr<QoreYamlOutputStreamWriteHandler> oh;
+    std::unique_ptr<QoreYamlEmitter> emitter;
+    // the lists and hashes currently open; true = hash
+    std::vector<bool> stack;
+    // the key of the next value in the current hash has been written
+    bool have_key = false;
+    // the root node of the current document has been written
+    bool have_root = false;
+    // close() has been called
+    bool closed = false;
+    // an exception was raised while writing output
+    bool failed = false;
+
+    //! checks if output can be written; returns 0 for OK, -1 if an exception was raised
+    DLLLOCAL int check(ExceptionSink* xsink);
+
+    //! checks if a node can be written at the current position; returns 0 for OK, -1 if an exception was raised
+    DLLLOCAL int checkNode(ExceptionSink* xsink);
+
+    //! checks if the current document is complete; returns 0 for OK, -1 if an exception was raised
+    DLLLOCAL int checkDocument(const char* meth, ExceptionSink* xsink);
+
+    //! records the result of writing output
+    DLLLOCAL int result(int rc) {
+        if (rc) {
+            failed = true;
+        }
+        return rc;
+    }
+};
+
+#endif
@@ -0,0 +1,341 @@
+/* indent-tabs-mode: nil -*- */
+/*
+    yaml Qore module
+
+    Copyright (C) 2010 - 2022 Qore Technologies, s.r.o.
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "yaml-module.h"
+
+#include <stdlib.h>
+#include <stdint.h>
+
+// SSSE3 and AVX2 implementations are compiled with function-level target attributes and selected at runtime
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define QORE_YAML_BASE64_X86 1
+#include <immintrin.h>
+#endif
+
+// extra space at the end of output buffers for vector stores
+#define QYB64_SLACK 32
+
+static const char yaml_b64_enc[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// decoding table values for characters other than base64 digits
+#define QYB64_INVALID 0xff
+#define QYB64_SPACE   0xfe
+#define QYB64_PAD     0xfd
+
+static unsigned char yaml_b64_dec[256];
+
+static bool yaml_b64_init() {
+    memset(yaml_b64_dec, QYB64_INVALID, sizeof yaml_b64_dec);
+    for (unsigned i = 0; i < 64; ++i) {
+        yaml_b64_dec[(unsigned char)yaml_b64_enc[i]] = (unsigned char)i;
+    }
+    yaml_b64_dec[(unsigned char)' '] = QYB64_SPACE;
+    yaml_b64_dec[(unsigned char)'\t'] = QYB64_SPACE;
+    yaml_b64_dec[(unsigned char)'\r'] = QYB64_SPACE;
+    yaml_b64_dec[(unsigned char)'\n'] = QYB64_SPACE;
+    yaml_b64_dec[(unsigned char)'='] = QYB64_PAD;
+    return true;
+}
+
+static bool yaml_b64_init_done = yaml_b64_init();
+
+// encodes complete 3-byte groups; returns the number of input bytes consumed
+typedef size_t (*yaml_b64_enc_func_t)(const unsigned char* src, size_t len, char* dst);
+// decodes blocks without whitespace or padding; returns the number of input bytes consumed, always a multiple of 4
+typedef size_t (*yaml_b64_dec_func_t)(const char* src, size_t len, unsigned char* dst);
+
+static size_t yaml_b64_enc_scalar(const unsigned char* src, size_t len, char* dst) {
+    size_t n = len - len % 3;
+    for (size_t i = 0; i < n; i += 3) {
+        uint32_t v = ((uint32_t)src[i] << 16) | ((uint32_t)src[i + 1] << 8) | src[i + 2];
+        *dst++ = yaml_b64_enc[v >> 18];
+        *dst++ = yaml_b64_enc[(v >> 12) & 0x3f];
+        *dst++ = yaml_b64_enc[(v >> 6) & 0x3f];
+        *dst++ = yaml_b64_enc[v & 0x3f];
+    }
+    return n;
+}
+
+static size_t yaml_b64_dec_scalar(const char* src, size_t len, unsigned char* dst) {
+    const unsigned char* p = (const unsigned char*)src;
+    size_t i = 0;
+    for (; i + 4 <= len; i += 4) {
+        unsigned a = yaml_b64_dec[p[i]];
+        unsigned b = yaml_b64_dec[p[i + 1]];
+        unsigned c = yaml_b64_dec[p[i + 2]];
+        unsigned d = yaml_b64_dec[p[i + 3]];
+        // all values >= 64 are not base64 digits
+        if ((a | b | c | d) & 0xc0)
+            break;
+        uint32_t v = (a << 18) | (b << 12) | (c << 6) | d;
+        *dst++ = (unsigned char)(v >> 16);
+        *dst++ = (unsigned char)(v >> 8);
+        *dst++ = (unsigned char)v;
+    }
+    return i;
+}
+
+#ifdef QORE_YAML_BASE64_X86
+// maps 6-bit values to base64 digits
+__attribute__((target("ssse3")))
+static inline __m128i yaml_b64_enc_lookup_ssse3(__m128i idx) {
+    __m128i res = _mm_subs_epu8(idx, _mm_set1_epi8(51));
+    __m128i less = _mm_cmpgt_epi8(_mm_set1_epi8(26), idx);
+    res = _mm_or_si128(res, _mm_and_si128(less, _mm_set1_epi8(13)));
+    const __m128i shift = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+        '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+    return _mm_add_epi8(_mm_shuffle_epi8(shift, res), idx);
+}
+
+// splits 3-byte groups into 6-bit values in each 32-bit lane
+__attribute__((target("ssse3")))
+static inline __m128i yaml_b64_enc_split_ssse3(__m128i in) {
+    in = _mm_shuffle_epi8(in, _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10));
+    __m128i t0 = _mm_mulhi_epu16(_mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00)), _mm_set1_epi32(0x04000040));
+    __m128i t1 = _mm_mullo_epi16(_mm_and_si128(in, _mm_set1_epi32(0x003f03f0)), _mm_set1_epi32(0x01000010));
+    return _mm_or_si128(t0, t1);
+}
+
+__attribute__((target("ssse3")))
+static size_t yaml_b64_enc_ssse3(const unsigned char* src, size_t len, char* dst) {
+    size_t i = 0;
+    // 16 bytes are read for each 12 bytes encoded
+    for (; i + 16 <= len; i += 12, dst += 16) {
+        __m128i in = _mm_loadu_si128((const __m128i*)(src + i));
+        _mm_storeu_si128((__m128i*)dst, yaml_b64_enc_lookup_ssse3(yaml_b64_enc_split_ssse3(in)));
+    }
+    return i + yaml_b64_enc_scalar(src + i, len - i, dst);
+}
+
+__attribute__((target("avx2")))
+static size_t yaml_b64_enc_avx2(const unsigned char* src, size_t len, char* dst) {
+    size_t i = 0;
+    // 28 bytes are read for each 24 bytes encoded
+    for (; i + 28 <= len; i += 24, dst += 32) {
+        __m256i in = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)(src + i))),
+            _mm_loadu_si128((const __m128i*)(src + i + 12)), 1);
+        in = _mm256_shuffle_epi8(in, _mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+            1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10));
+        __m256i t0 = _mm256_mulhi_epu16(_mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00)),
+            _mm256_set1_epi32(0x04000040));
+        __m256i t1 = _mm256_mullo_epi16(_mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0)),
+            _mm256_set1_epi32(0x01000010));
+        __m256i idx = _mm256_or_si256(t0, t1);
+
+        __m256i res = _mm256_subs_epu8(idx, _mm256_set1_epi8(51));
+        __m256i less = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), idx);
+        res = _mm256_or_si256(res, _mm256_and_si256(less, _mm256_set1_epi8(13)));
+        const __m256i shift = _mm256_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+            '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0,
+            'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+            '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+        _mm256_storeu_si256((__m256i*)dst, _mm256_add_epi8(_mm256_shuffle_epi8(shift, res), idx));
+    }
+    return i + yaml_b64_enc_ssse3(src + i, len - i, dst);
+}
+
+// translates base64 digits to 6-bit values and packs them; 16 input bytes give 12 output bytes; returns a bitmask
+// of the input bytes that are not base64 digits
+__attribute__((target("ssse3")))
+static inline int yaml_b64_dec_block_ssse3(__m128i in, __m128i& out) {
+    const __m128i lut_lo = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1a,
+        0x1b, 0x1b, 0x1b, 0x1a);
+    const __m128i lut_hi = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10,
+        0x10, 0x10, 0x10, 0x10);
+    const __m128i lut_roll = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m128i mask_2f = _mm_set1_epi8(0x2f);
+
+    __m128i hi_nibbles = _mm_and_si128(_mm_srli_epi32(in, 4), mask_2f);
+    __m128i lo = _mm_shuffle_epi8(lut_lo, _mm_and_si128(in, mask_2f));
+    __m128i hi = _mm_shuffle_epi8(lut_hi, hi_nibbles);
+    int invalid = _mm_movemask_epi8(_mm_cmpgt_epi8(_mm_and_si128(lo, hi), _mm_setzero_si128()));
+    // bytes >= 0x80 are negative and never compare greater than zero
+    invalid |= _mm_movemask_epi8(in);
+    if (invalid)
+        return invalid;
+
+    __m128i roll = _mm_shuffle_epi8(lut_roll, _mm_add_epi8(_mm_cmpeq_epi8(in, mask_2f), hi_nibbles));
+    in = _mm_add_epi8(in, roll);
+    __m128i v = _mm_madd_epi16(_mm_maddubs_epi16(in, _mm_set1_epi32(0x01400140)), _mm_set1_epi32(0x00011000));
+    out = _mm_shuffle_epi8(v, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+    return 0;
+}
+
+__attribute__((target("ssse3")))
+static size_t yaml_b64_dec_ssse3(const char* src, size_t len, unsigned char* dst) {
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16, dst += 12) {
+        __m128i out;
+        if (yaml_b64_dec_block_ssse3(_mm_loadu_si128((const __m128i*)(src + i)), out))
+            break;
+        _mm_storeu_si128((__m128i*)dst, out);
+    }
+    return i + yaml_b64_dec_scalar(src + i, len - i, dst);
+}
+
+__attribute__((target("avx2")))
+static size_t yaml_b64_dec_avx2(const char* src, size_t len, unsigned char* dst) {
+    const __m256i lut_lo = _mm256_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1a,
+        0x1b, 0x1b, 0x1b, 0x1a, 0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b,
+        0x1b, 0x1a);
+    const __m256i lut_hi = _mm256_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10,
+        0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+        0x10, 0x10);
+    const __m256i lut_roll = _mm256_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m256i mask_2f = _mm256_set1_epi8(0x2f);
+
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32, dst += 24) {
+        __m256i in = _mm256_loadu_si256((const __m256i*)(src + i));
+        __m256i hi_nibbles = _mm256_and_si256(_mm256_srli_epi32(in, 4), mask_2f);
+        __m256i lo = _mm256_shuffle_epi8(lut_lo, _mm256_and_si256(in, mask_2f));
+        __m256i hi = _mm256_shuffle_epi8(lut_hi, hi_nibbles);
+        if (_mm256_movemask_epi8(_mm256_cmpgt_epi8(_mm256_and_si256(lo, hi), _mm256_setzero_si256()))
+            | _mm256_movemask_epi8(in))
+            break;
+
+        __m256i roll = _mm256_shuffle_epi8(lut_roll, _mm256_add_epi8(_mm256_cmpeq_epi8(in, mask_2f), hi_nibbles));
+        in = _mm256_add_epi8(in, roll);
+        __m256i v = _mm256_madd_epi16(_mm256_maddubs_epi16(in, _mm256_set1_epi32(0x01400140)),
+            _mm256_set1_epi32(0x00011000));
+        v = _mm256_shuffle_epi8(v, _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+            2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+        v = _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7));
+        _mm256_storeu_si256((__m256i*)dst, v);
+    }
+    return i + yaml_b64_dec_ssse3(src + i, len - i, dst);
+}
+#endif
+
+static yaml_b64_enc_func_t yaml_b64_get_encoder() {
+#ifdef QORE_YAML_BASE64_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return yaml_b64_enc_avx2;
+    if (__builtin_cpu_supports("ssse3"))
+        return yaml_b64_enc_ssse3;
+#endif
+    return yaml_b64_enc_scalar;
+}
+
+static yaml_b64_dec_func_t yaml_b64_get_decoder() {
+#ifdef QORE_YAML_BASE64_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return yaml_b64_dec_avx2;
+    if (__builtin_cpu_supports("ssse3"))
+        return yaml_b64_dec_ssse3;
+#endif
+    return yaml_b64_dec_scalar;
+}
+
+static const yaml_b64_enc_func_t yaml_b64_enc_func = yaml_b64_get_encoder();
+static const yaml_b64_dec_func_t yaml_b64_dec_func = yaml_b64_get_decoder();
+
+size_t q_yaml_base64_encode_raw(const void* data, size_t len, char* dst) {
+    const unsigned char* src = (const unsigned char*)data;
+    size_t done = yaml_b64_enc_func(src, len, dst);
+    char* p = dst + done / 3 * 4;
+
+    // encode the remaining bytes with padding
+    size_t rem = len - done;
+    if (rem) {
+        uint32_t v = (uint32_t)src[done] << 16;
+        if (rem == 2)
+            v |= (uint32_t)src[done + 1] << 8;
+        *p++ = yaml_b64_enc[v >> 18];
+        *p++ = yaml_b64_enc[(v >> 12) & 0x3f];
+        *p++ = rem == 2 ? yaml_b64_enc[(v >> 6) & 0x3f] : '=';
+        *p++ = '=';
+    }
+    return p - dst;
+}
+
+ssize_t q_yaml_base64_decode_raw(const char* src, size_t len, unsigned char* dst) {
+    const unsigned char* p = (const unsigned char*)src;
+    const unsigned char* end = p + len;
+    unsigned char* out = dst;
+
+    // the current group of up to 4 digits
+    uint32_t v = 0;
+    unsigned n = 0;
+    unsigned pad = 0;
+    while (p < end) {
+        // decode runs of digits at group boundaries with the vectorized decoder, which stops at the first block
+        // containing whitespace or padding
+        if (!n && !pad) {
+            size_t done = yaml_b64_dec_func((const char*)p, end - p, out);
+            p += done;
+            out += done / 4 * 3;
+            if (p == end)
+                break;
+        }
+
+        unsigned c = yaml_b64_dec[*p++];
+        if (c < 64) {
+            if (pad)
+                return -1;
+            v = (v << 6) | c;
+            if (++n == 4) {
+                *out++ = (unsigned char)(v >> 16);
+                *out++ = (unsigned char)(v >> 8);
+                *out++ = (unsigned char)v;
+                v = 0;
+                n = 0;
+            }
+            continue;
+        }
+        if (c == QYB64_SPACE)
+            continue;
+        if (c != QYB64_PAD || n < 2 || (n + ++pad) > 4)
+            return -1;
+    }
+
+    // the last group may be incomplete if padding is omitted
+    if (n == 1)
+        return -1;
+    if (n >= 2) {
+        v <<= (4 - n) * 6;
+        *out++ = (unsigned char)(v >> 16);
+        if (n == 3)
+            *out++ = (unsigned char)(v >> 8);
+    }
+    return out - dst;
+}
+
+void q_yaml_base64_encode(const void* data, size_t len, QoreString& str) {
+    size_t size = (len + 2) / 3 * 4;
+    char* buf = (char*)malloc(size + QYB64_SLACK);
+    size = q_yaml_base64_encode_raw(data, len, buf);
+    str.takeAndTerminate(buf, size);
+}
+
+BinaryNode* q_yaml_base64_decode(const char* data, size_t len, ExceptionSink* xsink) {
+    unsigned char* buf = (unsigned char*)malloc(len / 4 * 3 + 3 + QYB64_SLACK);
+    ssize_t size = q_yaml_base64_decode_raw(data, len, buf);
+    if (size < 0) {
+        free(buf);
+        xsink->raiseException("BASE64-PARSE-ERROR", "invalid base64 data in !!binary value");
+        return nullptr;
+    }
+    return new BinaryNode(buf, size);
+}
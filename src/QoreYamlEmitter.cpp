@@ -21,18 +21,116 @@
 
 #include "yaml-module.h"
 
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <cmath>
+
 const char* QY_EMIT_ERR = "YAML-EMITTER-ERROR";
 
 static int qore_yaml_write_handler(QoreYamlWriteHandler* wh, unsigned char* buffer, size_t size) {
     return wh->write(buffer, size);
 }
 
+#ifdef QORE_YAML_CONTEXT_CACHE
+namespace {
+// a libyaml emitter context cached by each thread
+struct QoreYamlEmitterCache {
+    yaml_emitter_t emitter;
+    bool set = false;
+
+    DLLLOCAL ~QoreYamlEmitterCache() {
+        if (set) {
+            yaml_emitter_delete(&emitter);
+        }
+    }
+};
+}
+
+static thread_local QoreYamlEmitterCache yaml_emitter_cache;
+#endif
+
+// the output buffer for QoreYamlStringWriteHandler cached by each thread
+static thread_local std::string yaml_output_cache;
+
+int q_yaml_emitter_acquire(yaml_emitter_t& e) {
+#ifdef QORE_YAML_CONTEXT_CACHE
+    if (yaml_emitter_cache.set) {
+        memcpy(&e, &yaml_emitter_cache.emitter, sizeof e);
+        yaml_emitter_cache.set = false;
+        return 1;
+    }
+#endif
+    return yaml_emitter_initialize(&e);
+}
+
+void q_yaml_emitter_release(yaml_emitter_t& e) {
+#ifndef QORE_YAML_CONTEXT_CACHE
+    yaml_emitter_delete(&e);
+#else
+    // contexts whose stacks have grown for deeply-nested output are not kept
+    if (yaml_emitter_cache.set || !e.buffer.start || e.anchors
+        || q_yaml_stack_bytes(e.states) > YAML_CONTEXT_MAX_STACK
+        || q_yaml_stack_bytes(e.events) > YAML_CONTEXT_MAX_STACK
+        || q_yaml_stack_bytes(e.indents) > YAML_CONTEXT_MAX_STACK
+        || q_yaml_stack_bytes(e.tag_directives) > YAML_CONTEXT_MAX_STACK) {
+        yaml_emitter_delete(&e);
+        return;
+    }
+
+    // free data left by incomplete output as yaml_emitter_delete() does
+    while (e.events.head != e.events.tail) {
+        yaml_event_delete(e.events.head++);
+    }
+    while (e.tag_directives.top != e.tag_directives.start) {
+        --e.tag_directives.top;
+        free(e.tag_directives.top->handle);
+        free(e.tag_directives.top->prefix);
+    }
+
+    // reset the state as yaml_emitter_initialize() does, keeping the allocated buffers and stacks; this assumes the
+    // yaml_emitter_t layout and initial state of libyaml 0.2.1 - 0.2.5, which is checked when the module is configured
+    yaml_emitter_t& c = yaml_emitter_cache.emitter;
+    memset(&c, 0, sizeof c);
+    c.buffer.start = c.buffer.pointer = c.buffer.last = e.buffer.start;
+    c.buffer.end = e.buffer.end;
+    c.raw_buffer.start = c.raw_buffer.pointer = c.raw_buffer.last = e.raw_buffer.start;
+    c.raw_buffer.end = e.raw_buffer.end;
+    c.states.start = c.states.top = e.states.start;
+    c.states.end = e.states.end;
+    c.events.start = c.events.head = c.events.tail = e.events.start;
+    c.events.end = e.events.end;
+    c.indents.start = c.indents.top = e.indents.start;
+    c.indents.end = e.indents.end;
+    c.tag_directives.start = c.tag_directives.top = e.tag_directives.start;
+    c.tag_directives.end = e.tag_directives.end;
+    yaml_emitter_cache.set = true;
+#endif
+}
+
+QoreYamlStringWriteHandler::QoreYamlStringWriteHandler() {
+    // take the buffer of the current thread; nested objects allocate their own buffers
+    buf.swap(yaml_output_cache);
+}
+
+QoreYamlStringWriteHandler::~QoreYamlStringWriteHandler() {
+    if (str) {
+        str->deref();
+    }
+    if (yaml_output_cache.capacity() < buf.capacity()) {
+        buf.clear();
+        buf.swap(yaml_output_cache);
+    }
+}
+
 QoreYamlEmitter::QoreYamlEmitter(QoreYamlWriteHandler& wh, int flags, int width, int indent, ExceptionSink* xsink)
-        : QoreYamlBase(xsink), wh(wh), block(flags & QYE_BLOCK_STYLE),
+        : QoreYamlEmitterBase(xsink), wh(wh), block(flags & QYE_BLOCK_STYLE),
             implicit_start_doc(!(flags & QYE_EXPLICIT_START_DOC)),
             implicit_end_doc(!(flags & QYE_EXPLICIT_END_DOC)),
-            emit_sqlnull(flags & QYE_EMIT_SQLNULL) {
-    if (!yaml_emitter_initialize(&emitter)) {
+            emit_sqlnull(flags & QYE_EMIT_SQLNULL),
+            emit_aliases(flags & QYE_EMIT_ALIASES) {
+    if (!q_yaml_emitter_acquire(emitter)) {
         err("unknown error initializing yaml emitter");
         return;
     }
@@ -67,6 +165,92 @@ QoreYamlEmitter::QoreYamlEmitter(QoreYamlWriteHandler& wh, int flags, int width,
     }
 }
 
+int QoreYamlEmitter::emitRoot(const QoreValue& v) {
+    if (!emit_aliases) {
+        return emit(v);
+    }
+
+    scanAliases(v);
+    // only keep containers that appear more than once
+    for (anchor_map_t::iterator i = anchors.begin(), e = anchors.end(); i != e;) {
+        if (i->second.count == 1) {
+            anchors.erase(i++);
+        } else {
+            ++i;
+        }
+    }
+
+    int rc = emit(v);
+    anchors.clear();
+    anchor_id = 0;
+    return rc;
+}
+
+int QoreYamlEmitter::emitDocuments(const QoreListNode& l) {
+    ConstListIterator li(l);
+    while (li.next()) {
+        if (li.index() && (docEnd() || docStart())) {
+            return -1;
+        }
+        if (emitRoot(li.getValue())) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+void QoreYamlEmitter::scanAliases(const QoreValue& v) {
+    switch (v.getType()) {
+        case NT_LIST:
+        case NT_HASH: {
+            const AbstractQoreNode* n = v.getInternalNode();
+            // a container with a single reference cannot appear more than once
+            if (n->reference_count() > 1) {
+                anchor_map_t::iterator i = anchors.lower_bound(n);
+                if (i != anchors.end() && i->first == n) {
+                    // do not scan the contents again
+                    ++i->second.count;
+                    return;
+                }
+                anchors.insert(i, anchor_map_t::value_type(n, QoreYamlAnchor()));
+            }
+
+            if (v.getType() == NT_LIST) {
+                ConstListIterator li(*v.get<const QoreListNode>());
+                while (li.next()) {
+                    scanAliases(li.getValue());
+                }
+            } else {
+                ConstHashIterator hi(*v.get<const QoreHashNode>());
+                while (hi.next()) {
+                    scanAliases(hi.get());
+                }
+            }
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+int QoreYamlEmitter::checkAlias(const AbstractQoreNode* n, char* buf, const char*& anchor) {
+    anchor_map_t::iterator i = anchors.find(n);
+    if (i == anchors.end()) {
+        return 0;
+    }
+
+    if (i->second.id) {
+        sprintf(buf, "id%03u", i->second.id);
+        return emitAlias(buf) ? -1 : 1;
+    }
+
+    i->second.id = ++anchor_id;
+    sprintf(buf, "id%03u", i->second.id);
+    anchor = buf;
+    return 0;
+}
+
 int QoreYamlEmitter::emit(const QoreValue& v) {
     switch (v.getType()) {
         case NT_STRING:
@@ -113,90 +297,409 @@ int QoreYamlEmitter::emit(const QoreValue& v) {
     return 0;
 }
 
+// shortest round-trip formatting of floating-point values with the Grisu2 algorithm by Florian Loitsch
+
+namespace {
+// a floating-point value with a 64-bit significand and a binary exponent
+struct QoreYamlDiyFp {
+    uint64_t f;
+    int e;
+
+    DLLLOCAL QoreYamlDiyFp(uint64_t f, int e) : f(f), e(e) {
+    }
+
+    DLLLOCAL QoreYamlDiyFp operator-(const QoreYamlDiyFp& rhs) const {
+        return QoreYamlDiyFp(f - rhs.f, e);
+    }
+
+    // returns the rounded upper 64 bits of the product
+    DLLLOCAL QoreYamlDiyFp operator*(const QoreYamlDiyFp& rhs) const {
+        uint64_t a = f >> 32, b = f & 0xffffffff, c = rhs.f >> 32, d = rhs.f & 0xffffffff;
+        uint64_t ac = a * c, bc = b * c, ad = a * d, bd = b * d;
+        uint64_t tmp = (bd >> 32) + (ad & 0xffffffff) + (bc & 0xffffffff) + (1U << 31);
+        return QoreYamlDiyFp(ac + (ad >> 32) + (bc >> 32) + (tmp >> 32), e + rhs.e + 64);
+    }
+
+    DLLLOCAL QoreYamlDiyFp normalize() const {
+        QoreYamlDiyFp rv = *this;
+        while (!(rv.f & (1ULL << 63))) {
+            rv.f <<= 1;
+            --rv.e;
+        }
+        return rv;
+    }
+};
+}
+
+// normalized powers of ten from 10^-348 to 10^340 in steps of 8
+static const uint64_t yaml_pow10_f[] = {
+    0xfa8fd5a0081c0288ULL, 0xbaaee17fa23ebf76ULL, 0x8b16fb203055ac76ULL, 0xcf42894a5dce35eaULL,
+    0x9a6bb0aa55653b2dULL, 0xe61acf033d1a45dfULL, 0xab70fe17c79ac6caULL, 0xff77b1fcbebcdc4fULL,
+    0xbe5691ef416bd60cULL, 0x8dd01fad907ffc3cULL, 0xd3515c2831559a83ULL, 0x9d71ac8fada6c9b5ULL,
+    0xea9c227723ee8bcbULL, 0xaecc49914078536dULL, 0x823c12795db6ce57ULL, 0xc21094364dfb5637ULL,
+    0x9096ea6f3848984fULL, 0xd77485cb25823ac7ULL, 0xa086cfcd97bf97f4ULL, 0xef340a98172aace5ULL,
+    0xb23867fb2a35b28eULL, 0x84c8d4dfd2c63f3bULL, 0xc5dd44271ad3cdbaULL, 0x936b9fcebb25c996ULL,
+    0xdbac6c247d62a584ULL, 0xa3ab66580d5fdaf6ULL, 0xf3e2f893dec3f126ULL, 0xb5b5ada8aaff80b8ULL,
+    0x87625f056c7c4a8bULL, 0xc9bcff6034c13053ULL, 0x964e858c91ba2655ULL, 0xdff9772470297ebdULL,
+    0xa6dfbd9fb8e5b88fULL, 0xf8a95fcf88747d94ULL, 0xb94470938fa89bcfULL, 0x8a08f0f8bf0f156bULL,
+    0xcdb02555653131b6ULL, 0x993fe2c6d07b7facULL, 0xe45c10c42a2b3b06ULL, 0xaa242499697392d3ULL,
+    0xfd87b5f28300ca0eULL, 0xbce5086492111aebULL, 0x8cbccc096f5088ccULL, 0xd1b71758e219652cULL,
+    0x9c40000000000000ULL, 0xe8d4a51000000000ULL, 0xad78ebc5ac620000ULL, 0x813f3978f8940984ULL,
+    0xc097ce7bc90715b3ULL, 0x8f7e32ce7bea5c70ULL, 0xd5d238a4abe98068ULL, 0x9f4f2726179a2245ULL,
+    0xed63a231d4c4fb27ULL, 0xb0de65388cc8ada8ULL, 0x83c7088e1aab65dbULL, 0xc45d1df942711d9aULL,
+    0x924d692ca61be758ULL, 0xda01ee641a708deaULL, 0xa26da3999aef774aULL, 0xf209787bb47d6b85ULL,
+    0xb454e4a179dd1877ULL, 0x865b86925b9bc5c2ULL, 0xc83553c5c8965d3dULL, 0x952ab45cfa97a0b3ULL,
+    0xde469fbd99a05fe3ULL, 0xa59bc234db398c25ULL, 0xf6c69a72a3989f5cULL, 0xb7dcbf5354e9beceULL,
+    0x88fcf317f22241e2ULL, 0xcc20ce9bd35c78a5ULL, 0x98165af37b2153dfULL, 0xe2a0b5dc971f303aULL,
+    0xa8d9d1535ce3b396ULL, 0xfb9b7cd9a4a7443cULL, 0xbb764c4ca7a44410ULL, 0x8bab8eefb6409c1aULL,
+    0xd01fef10a657842cULL, 0x9b10a4e5e9913129ULL, 0xe7109bfba19c0c9dULL, 0xac2820d9623bf429ULL,
+    0x80444b5e7aa7cf85ULL, 0xbf21e44003acdd2dULL, 0x8e679c2f5e44ff8fULL, 0xd433179d9c8cb841ULL,
+    0x9e19db92b4e31ba9ULL, 0xeb96bf6ebadf77d9ULL, 0xaf87023b9bf0ee6bULL,
+};
+
+static const int16_t yaml_pow10_e[] = {
+    -1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980, -954, -927, -901, -874, -847, -821, -794,
+    -768, -741, -715, -688, -661, -635, -608, -582, -555, -529, -502, -475, -449, -422, -396, -369, -343, -316,
+    -289, -263, -236, -210, -183, -157, -130, -103, -77, -50, -24, 3, 30, 56, 83, 109, 136, 162, 189, 216, 242, 269,
+    295, 322, 348, 375, 402, 428, 455, 481, 508, 534, 561, 588, 614, 641, 667, 694, 720, 747, 774, 800, 827, 853,
+    880, 907, 933, 960, 986, 1013, 1039, 1066,
+};
+
+static const uint64_t yaml_pow10[] = {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL, 1000000000ULL,
+    10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL, 100000000000000ULL,
+    1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL, 1000000000000000000ULL,
+    10000000000000000000ULL,
+};
+
+// moves the last digit towards the exact value while the result stays within the rounding interval
+static void yaml_grisu_round(char* buf, int len, uint64_t delta, uint64_t rest, uint64_t ten_kappa, uint64_t wp_w) {
+    while (rest < wp_w && delta - rest >= ten_kappa
+        && (rest + ten_kappa < wp_w || wp_w - rest > rest + ten_kappa - wp_w)) {
+        --buf[len - 1];
+        rest += ten_kappa;
+    }
+}
+
+// generates the shortest digits in the interval [mp - delta, mp] and adjusts the decimal exponent k
+static int yaml_grisu_digits(const QoreYamlDiyFp& w, const QoreYamlDiyFp& mp, uint64_t delta, char* buf, int& k) {
+    const QoreYamlDiyFp one(1ULL << -mp.e, mp.e);
+    const QoreYamlDiyFp wp_w = mp - w;
+    uint32_t p1 = (uint32_t)(mp.f >> -one.e);
+    uint64_t p2 = mp.f & (one.f - 1);
+
+    int kappa = 1;
+    while (kappa < 10 && p1 >= yaml_pow10[kappa]) {
+        ++kappa;
+    }
+
+    int len = 0;
+    while (kappa > 0) {
+        uint32_t div = (uint32_t)yaml_pow10[kappa - 1];
+        uint32_t d = p1 / div;
+        p1 %= div;
+        if (d || len) {
+            buf[len++] = (char)('0' + d);
+        }
+        --kappa;
+        uint64_t rest = ((uint64_t)p1 << -one.e) + p2;
+        if (rest <= delta) {
+            k += kappa;
+            yaml_grisu_round(buf, len, delta, rest, yaml_pow10[kappa] << -one.e, wp_w.f);
+            return len;
+        }
+    }
+
+    while (true) {
+        p2 *= 10;
+        delta *= 10;
+        char d = (char)(p2 >> -one.e);
+        if (d || len) {
+            buf[len++] = (char)('0' + d);
+        }
+        p2 &= one.f - 1;
+        --kappa;
+        if (p2 < delta) {
+            k += kappa;
+            yaml_grisu_round(buf, len, delta, p2, one.f, -kappa < 20 ? wp_w.f * yaml_pow10[-kappa] : 0);
+            return len;
+        }
+    }
+}
+
+// writes the shortest digits of a positive finite value to buf; returns the number of digits, and the value is
+// digits * 10^k
+static int yaml_grisu2(double value, char* buf, int& k) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof bits);
+    uint64_t f = bits & 0xfffffffffffffULL;
+    int biased_e = (int)((bits >> 52) & 0x7ff);
+    int e;
+    if (biased_e) {
+        f += 1ULL << 52;
+        e = biased_e - 1075;
+    } else {
+        e = -1074;
+    }
+
+    // the boundaries of the rounding interval, with the same exponent
+    QoreYamlDiyFp plus((f << 1) + 1, e - 1);
+    while (!(plus.f & (1ULL << 53))) {
+        plus.f <<= 1;
+        --plus.e;
+    }
+    plus.f <<= 10;
+    plus.e -= 10;
+    QoreYamlDiyFp minus = (f == (1ULL << 52)) ? QoreYamlDiyFp((f << 2) - 1, e - 2) : QoreYamlDiyFp((f << 1) - 1, e - 1);
+    minus.f <<= minus.e - plus.e;
+    minus.e = plus.e;
+
+    // get a cached power of ten to bring the exponent of the product into the range [-60, -32]
+    double dk = (-61 - plus.e) * 0.30102999566398114 + 347;
+    int ik = (int)dk;
+    if (dk - ik > 0.0) {
+        ++ik;
+    }
+    unsigned index = (unsigned)((ik >> 3) + 1);
+    k = -(-348 + (int)(index << 3));
+    const QoreYamlDiyFp c_mk(yaml_pow10_f[index], yaml_pow10_e[index]);
+
+    const QoreYamlDiyFp w = QoreYamlDiyFp(f, e).normalize() * c_mk;
+    QoreYamlDiyFp wp = plus * c_mk;
+    QoreYamlDiyFp wm = minus * c_mk;
+    ++wm.f;
+    --wp.f;
+    return yaml_grisu_digits(w, wp, wp.f - wm.f, buf, k);
+}
+
+size_t QoreYamlEmitterBase::formatValue(int64 i, char* buf) {
+    char tmp[20];
+    // write the digits backwards from the end of the temporary buffer
+    char* p = tmp + sizeof tmp;
+    uint64_t u = i < 0 ? -(uint64_t)i : i;
+    do {
+        *--p = '0' + (u % 10);
+        u /= 10;
+    } while (u);
+    char* start = buf;
+    if (i < 0) {
+        *buf++ = '-';
+    }
+    size_t len = tmp + sizeof tmp - p;
+    memcpy(buf, p, len);
+    buf[len] = '\0';
+    return buf + len - start;
+}
+
+size_t QoreYamlEmitterBase::formatValue(double f, char* buf) {
+    char* p = buf;
+    if (std::isnan(f)) {
+        memcpy(p, "@nan@", 6);
+        return 5;
+    }
+    if (std::signbit(f)) {
+        *p++ = '-';
+        f = -f;
+    }
+    if (std::isinf(f)) {
+        memcpy(p, "@inf@", 6);
+        return p + 5 - buf;
+    }
+    if (f == 0) {
+        memcpy(p, "0.0", 4);
+        return p + 3 - buf;
+    }
+
+    int k;
+    int len = yaml_grisu2(f, p, k);
+    // the position of the decimal point relative to the first digit
+    int kk = len + k;
+    if (k >= 0 && kk <= 21) {
+        // integral values are written with a trailing ".0" to be parsed as floats: 1234e2 -> 123400.0
+        memset(p + len, '0', k);
+        p += kk;
+        memcpy(p, ".0", 2);
+        p += 2;
+    } else if (kk > 0 && kk <= 21) {
+        // 1234e-2 -> 12.34
+        memmove(p + kk + 1, p + kk, len - kk);
+        p[kk] = '.';
+        p += len + 1;
+    } else if (kk > -6 && kk <= 0) {
+        // 1234e-6 -> 0.001234
+        int offset = 2 - kk;
+        memmove(p + offset, p, len);
+        p[0] = '0';
+        p[1] = '.';
+        memset(p + 2, '0', offset - 2);
+        p += len + offset;
+    } else {
+        // 1234e30 -> 1.234e+33
+        if (len > 1) {
+            memmove(p + 2, p + 1, len - 1);
+            p[1] = '.';
+            ++len;
+        }
+        p += len;
+        *p++ = 'e';
+        int exp = kk - 1;
+        if (exp < 0) {
+            *p++ = '-';
+            exp = -exp;
+        } else {
+            *p++ = '+';
+        }
+        if (exp >= 100) {
+            *p++ = (char)('0' + exp / 100);
+            exp %= 100;
+            *p++ = (char)('0' + exp / 10);
+        } else if (exp >= 10) {
+            *p++ = (char)('0' + exp / 10);
+        }
+        *p++ = (char)('0' + exp % 10);
+    }
+    *p = '\0';
+    return p - buf;
+}
+
 int QoreYamlEmitter::emitValue(const DateTime &d) {
+    char buf[YAML_DATE_BUFFER_SIZE];
+    const char* tag;
+    formatValue(d, emitter.canonical, buf, tag);
+    return emitScalar(buf, tag);
+}
+
+// writes a value with at least the given number of digits like "%0*d"; the width includes any sign
+static char* yaml_date_int(char* p, int v, int width = 1) {
+    uint32_t u = (uint32_t)v;
+    if (v < 0) {
+        *p++ = '-';
+        u = 0 - u;
+        --width;
+    }
+    char tmp[10];
+    int n = 0;
+    do {
+        tmp[n++] = (char)('0' + u % 10);
+        u /= 10;
+    } while (u);
+    for (; width > n; --width) {
+        *p++ = '0';
+    }
+    while (n) {
+        *p++ = tmp[--n];
+    }
+    return p;
+}
+
+// writes a value from 0 - 99 with two digits
+static inline char* yaml_date_2d(char* p, int v) {
+    *p++ = (char)('0' + v / 10);
+    *p++ = (char)('0' + v % 10);
+    return p;
+}
+
+// writes a duration component with its designator
+static inline char* yaml_date_component(char* p, int v, char c) {
+    p = yaml_date_int(p, v);
+    *p++ = c;
+    return p;
+}
+
+size_t QoreYamlEmitterBase::formatValue(const DateTime &d, bool canonical, char* buf, const char*& tag) {
     qore_tm info;
     d.getInfo(info);
 
-    QoreString str(QCS_UTF8);
-
+    char* p = buf;
     if (d.isRelative()) {
-        str.concat('P');
+        *p++ = 'P';
         if (d.hasValue()) {
             if (info.year)
-                str.sprintf("%dY", info.year);
+                p = yaml_date_component(p, info.year, 'Y');
             if (info.month)
-                str.sprintf("%dM", info.month);
+                p = yaml_date_component(p, info.month, 'M');
             if (info.day)
-                str.sprintf("%dD", info.day);
-
-            bool has_t = false;
-
-            if (info.hour) {
-                str.sprintf("T%dH", info.hour);
-                has_t = true;
-            }
-            if (info.minute) {
-                if (!has_t) {
-                    str.concat('T');
-                    has_t = true;
-                }
-                str.sprintf("%dM", info.minute);
-            }
-            if (info.second) {
-                if (!has_t) {
-                    str.concat('T');
-                    has_t = true;
-                }
-                str.sprintf("%dS", info.second);
-            }
-            if (info.us) {
-                if (!has_t) {
-                    str.concat('T');
-                    has_t = true;
-                }
-                str.sprintf("%du", info.us);
+                p = yaml_date_component(p, info.day, 'D');
+
+            if (info.hour || info.minute || info.second || info.us) {
+                *p++ = 'T';
+                if (info.hour)
+                    p = yaml_date_component(p, info.hour, 'H');
+                if (info.minute)
+                    p = yaml_date_component(p, info.minute, 'M');
+                if (info.second)
+                    p = yaml_date_component(p, info.second, 'S');
+                if (info.us)
+                    p = yaml_date_component(p, info.us, 'u');
             }
         } else {
-            str.concat("0D");
+            *p++ = '0';
+            *p++ = 'D';
         }
+        *p = '\0';
 
-        return emitScalar(str, QORE_YAML_DURATION_TAG);
+        tag = QORE_YAML_DURATION_TAG;
+        return p - buf;
     }
 
-    // shorthand type name
-    if (emitter.canonical) {
-        d.format(str, "YYYY-MM-DDTHH:mm:SS.xx");
-    } else {
-        d.format(str, "YYYY-MM-DD");
-        if (!info.isTimeNull() || info.secsEast()) {
-            // use spaces for enhanced readability
-            if (!info.us) {
-                d.format(str, " HH:mm:SS.");
-            } else if (!(info.us % 1000)) {
-                d.format(str, " HH:mm:SS.ms");
-            } else {
-                d.format(str, " HH:mm:SS.xx");
+    // YYYY-MM-DD
+    p = yaml_date_int(p, info.year, 4);
+    *p++ = '-';
+    p = yaml_date_2d(p, info.month);
+    *p++ = '-';
+    p = yaml_date_2d(p, info.day);
+
+    // the non-canonical format omits the time and the zone for dates at midnight UTC
+    bool has_time = canonical || !info.isTimeNull() || info.secsEast();
+    if (has_time) {
+        // use spaces for enhanced readability
+        *p++ = canonical ? 'T' : ' ';
+        p = yaml_date_2d(p, info.hour);
+        *p++ = ':';
+        p = yaml_date_2d(p, info.minute);
+        *p++ = ':';
+        p = yaml_date_2d(p, info.second);
+        // microseconds without trailing zeros
+        if (info.us) {
+            *p++ = '.';
+            int us = info.us;
+            int digits = 6;
+            while (!(us % 10)) {
+                us /= 10;
+                --digits;
             }
+            p = yaml_date_int(p, us, digits);
         }
-    }
-
-    // remove trailing zeros from microseconds time
-    str.trim_trailing('0');
-    // remove empty decimal point if us == 0
-    str.trim_trailing('.');
 
-    // if not emitting the canonical format and there is a time zone offset,
-    // then add a space
-    if (!emitter.canonical) {
-        if (!info.isTimeNull() || info.secsEast()) {
-            str.concat(' ');
-            // add time zone offset (or "Z")
-            d.format(str, "Z");
+        if (!canonical)
+            *p++ = ' ';
+
+        // add time zone offset (or "Z")
+        int offset = info.secsEast();
+        if (!offset) {
+            *p++ = 'Z';
+        } else if (offset % 60) {
+            // offsets with seconds are rare; use the library's formatting
+            QoreString tmp;
+            d.format(tmp, "Z");
+            size_t len = tmp.size() < 16 ? tmp.size() : 16;
+            memcpy(p, tmp.c_str(), len);
+            p += len;
+        } else {
+            if (offset < 0) {
+                *p++ = '-';
+                offset = -offset;
+            } else {
+                *p++ = '+';
+            }
+            p = yaml_date_int(p, offset / 3600, 2);
+            *p++ = ':';
+            p = yaml_date_2d(p, (offset % 3600) / 60);
         }
-    } else {
-        d.format(str, "Z");
     }
+    *p = '\0';
 
     // issue #2343: to avoid ambiguity with single quoted strings, we always use the tag here
-    return emitScalar(str, YAML_TIMESTAMP_TAG);
+    tag = YAML_TIMESTAMP_TAG;
+    return p - buf;
 }
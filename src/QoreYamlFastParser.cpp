@@ -0,0 +1,584 @@
+/* indent-tabs-mode: nil -*- */
+/*
+    yaml Qore module
+
+    Copyright (C) 2010 - 2022 Qore Technologies, s.r.o.
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "yaml-module.h"
+
+#include <string.h>
+
+/* The fast parser handles single-line documents in the form written by make_yaml() with the default flow style:
+   flow sequences and mappings, plain, single-quoted and double-quoted scalars, and scalars with known tags.  Each
+   check below is at least as strict as libyaml; any other input, including input that libyaml would reject, is
+   left to libyaml, so the results of both parsers are always the same.
+*/
+
+// the prefix of tags with the "!!" handle
+#define YAML_FAST_SECONDARY_PREFIX "tag:yaml.org,2002:"
+
+// a flow collection being parsed
+struct QoreYamlFastFrame {
+    // the list, or nullptr if the collection is a mapping
+    QoreListNode* l;
+    QoreHashNode* h;
+};
+
+// returns the width of the valid UTF-8 character starting at p, or 0 if the character is invalid, is not allowed
+// by libyaml, or is a line break or byte order mark; the first byte must be >= 0x80
+static unsigned yaml_fast_utf8(const unsigned char* p, const unsigned char* end) {
+    unsigned w, v;
+    if (*p < 0xc2) {
+        return 0;
+    }
+    if (*p < 0xe0) {
+        w = 2;
+        v = *p & 0x1f;
+    } else if (*p < 0xf0) {
+        w = 3;
+        v = *p & 0x0f;
+    } else if (*p < 0xf5) {
+        w = 4;
+        v = *p & 0x07;
+    } else {
+        return 0;
+    }
+    if ((size_t)(end - p) < w) {
+        return 0;
+    }
+    for (unsigned i = 1; i < w; ++i) {
+        if ((p[i] & 0xc0) != 0x80) {
+            return 0;
+        }
+        v = (v << 6) | (p[i] & 0x3f);
+    }
+    // reject overlong encodings, surrogates, C1 controls including NEL, and the other characters not allowed
+    if (v < 0xa0 || (w == 3 && v < 0x800) || (w == 4 && (v < 0x10000 || v > 0x10ffff))
+        || (v >= 0xd800 && v <= 0xdfff) || v == 0x2028 || v == 0x2029 || v == 0xfeff || v == 0xfffe
+        || v == 0xffff) {
+        return 0;
+    }
+    return w;
+}
+
+static void yaml_fast_append_utf8(std::string& buf, unsigned v) {
+    if (v < 0x80) {
+        buf += (char)v;
+    } else if (v < 0x800) {
+        buf += (char)(0xc0 | (v >> 6));
+        buf += (char)(0x80 | (v & 0x3f));
+    } else if (v < 0x10000) {
+        buf += (char)(0xe0 | (v >> 12));
+        buf += (char)(0x80 | ((v >> 6) & 0x3f));
+        buf += (char)(0x80 | (v & 0x3f));
+    } else {
+        buf += (char)(0xf0 | (v >> 18));
+        buf += (char)(0x80 | ((v >> 12) & 0x3f));
+        buf += (char)(0x80 | ((v >> 6) & 0x3f));
+        buf += (char)(0x80 | (v & 0x3f));
+    }
+}
+
+// scans a double-quoted scalar starting after the opening quote; returns a pointer after the closing quote or
+// nullptr if the scalar is not supported; if the scalar has escape sequences, the decoded value is stored in buf
+static const unsigned char* yaml_fast_scan_double(const unsigned char* p, const unsigned char* end, std::string& buf,
+        bool& decoded) {
+    decoded = false;
+    const unsigned char* run = p;
+    while (p < end) {
+        unsigned char c = *p;
+        if (c == '"') {
+            if (decoded) {
+                buf.append((const char*)run, p - run);
+            }
+            return p + 1;
+        }
+        if (c >= 0x80) {
+            unsigned w = yaml_fast_utf8(p, end);
+            if (!w) {
+                return nullptr;
+            }
+            p += w;
+            continue;
+        }
+        if (c < 0x20 || c == 0x7f) {
+            return nullptr;
+        }
+        if (c != '\\') {
+            ++p;
+            continue;
+        }
+
+        if (!decoded) {
+            buf.clear();
+            decoded = true;
+        }
+        buf.append((const char*)run, p - run);
+        if (++p == end) {
+            return nullptr;
+        }
+        unsigned digits = 0;
+        switch (*p) {
+            case '0': buf += '\0'; break;
+            case 'a': buf += '\a'; break;
+            case 'b': buf += '\b'; break;
+            case 't': buf += '\t'; break;
+            case 'n': buf += '\n'; break;
+            case 'v': buf += '\v'; break;
+            case 'f': buf += '\f'; break;
+            case 'r': buf += '\r'; break;
+            case 'e': buf += '\x1b'; break;
+            case ' ': buf += ' '; break;
+            case '"': buf += '"'; break;
+            case '\\': buf += '\\'; break;
+            case 'N': yaml_fast_append_utf8(buf, 0x85); break;
+            case '_': yaml_fast_append_utf8(buf, 0xa0); break;
+            case 'L': yaml_fast_append_utf8(buf, 0x2028); break;
+            case 'P': yaml_fast_append_utf8(buf, 0x2029); break;
+            case 'x': digits = 2; break;
+            case 'u': digits = 4; break;
+            case 'U': digits = 8; break;
+            default:
+                return nullptr;
+        }
+        ++p;
+        if (digits) {
+            if ((size_t)(end - p) < digits) {
+                return nullptr;
+            }
+            unsigned v = 0;
+            for (unsigned i = 0; i < digits; ++i, ++p) {
+                unsigned char h = *p;
+                if (h >= '0' && h <= '9') {
+                    v = (v << 4) | (h - '0');
+                } else if ((h | 0x20) >= 'a' && (h | 0x20) <= 'f') {
+                    v = (v << 4) | ((h | 0x20) - 'a' + 10);
+                } else {
+                    return nullptr;
+                }
+            }
+            if ((v >= 0xd800 && v <= 0xdfff) || v > 0x10ffff) {
+                return nullptr;
+            }
+            yaml_fast_append_utf8(buf, v);
+        }
+        run = p;
+    }
+    return nullptr;
+}
+
+// scans a single-quoted scalar starting after the opening quote; returns a pointer after the closing quote or
+// nullptr if the scalar is not supported; if the scalar has escaped quotes, the decoded value is stored in buf
+static const unsigned char* yaml_fast_scan_single(const unsigned char* p, const unsigned char* end, std::string& buf,
+        bool& decoded) {
+    decoded = false;
+    const unsigned char* run = p;
+    while (p < end) {
+        unsigned char c = *p;
+        if (c == '\'') {
+            if (p + 1 < end && p[1] == '\'') {
+                if (!decoded) {
+                    buf.clear();
+                    decoded = true;
+                }
+                buf.append((const char*)run, p - run + 1);
+                p += 2;
+                run = p;
+                continue;
+            }
+            if (decoded) {
+                buf.append((const char*)run, p - run);
+            }
+            return p + 1;
+        }
+        if (c >= 0x80) {
+            unsigned w = yaml_fast_utf8(p, end);
+            if (!w) {
+                return nullptr;
+            }
+            p += w;
+            continue;
+        }
+        if (c < 0x20 || c == 0x7f) {
+            return nullptr;
+        }
+        ++p;
+    }
+    return nullptr;
+}
+
+// scans a plain scalar in a flow collection or, if flow is false, at the root of the document; returns the end of
+// the value without trailing spaces or nullptr if the scalar is not supported
+static const unsigned char* yaml_fast_scan_plain(const unsigned char* p, const unsigned char* end, bool flow) {
+    // indicators cannot start a plain scalar, except "-" followed by a character that is not a space
+    switch (*p) {
+        case '-':
+            if (p + 1 == end || p[1] == ' ' || p[1] == '\n' || p[1] == ',' || p[1] == '[' || p[1] == ']'
+                || p[1] == '{' || p[1] == '}') {
+                return nullptr;
+            }
+            break;
+        case '?': case ':': case ',': case '[': case ']': case '{': case '}': case '#': case '&': case '*':
+        case '!': case '|': case '>': case '\'': case '"': case '%': case '@': case '`': case ' ': case '\n':
+            return nullptr;
+    }
+
+    const unsigned char* last = p;
+    while (p < end) {
+        unsigned char c = *p;
+        switch (c) {
+            case ' ':
+                ++p;
+                continue;
+            case '\n':
+                return last;
+            case ':': {
+                if (p + 1 == end || p[1] == ' ' || p[1] == '\n') {
+                    return last;
+                }
+                unsigned char n = p[1];
+                if (n == ',' || n == '?' || n == '[' || n == ']' || n == '{' || n == '}') {
+                    return nullptr;
+                }
+                break;
+            }
+            case ',':
+            case ']':
+            case '}':
+                return flow ? last : nullptr;
+            case '[':
+            case '{':
+                return nullptr;
+            case '#':
+                if (p[-1] == ' ') {
+                    return nullptr;
+                }
+                break;
+            default:
+                if (c >= 0x80) {
+                    unsigned w = yaml_fast_utf8(p, end);
+                    if (!w) {
+                        return nullptr;
+                    }
+                    p += w;
+                    last = p;
+                    continue;
+                }
+                if (c < 0x20 || c == 0x7f) {
+                    return nullptr;
+                }
+                break;
+        }
+        last = ++p;
+    }
+    return last;
+}
+
+static inline const unsigned char* yaml_fast_skip_spaces(const unsigned char* p, const unsigned char* end) {
+    while (p < end && *p == ' ') {
+        ++p;
+    }
+    return p;
+}
+
+bool QoreYamlParser::parseFast(QoreValue& rv) {
+    const unsigned char* p = (const unsigned char*)fast_data;
+    const unsigned char* end = p + fast_len;
+
+    // document markers are only supported as written by the emitter
+    if (fast_len >= 3 && (!memcmp(p, "---", 3) || !memcmp(p, "...", 3))) {
+        if (fast_len > 3 && p[0] == '-' && p[3] == ' ') {
+            p += 4;
+        } else if (fast_len == 3 || p[3] == ' ' || p[3] == '\t' || p[3] == '\r' || p[3] == '\n') {
+            return false;
+        }
+    }
+    if (p == end) {
+        return false;
+    }
+
+    // exceptions raised while converting scalars are discarded, and the input is parsed again by libyaml, which
+    // raises the same exceptions
+    ExceptionSink xs;
+    ExceptionSink* old_xsink = xsink;
+    xsink = &xs;
+    bool rc = parseFastIntern(p, end, rv);
+    xsink = old_xsink;
+    if (!rc) {
+        rv.discard(&xs);
+        rv = QoreValue();
+        xs.clear();
+    }
+    return rc;
+}
+
+bool QoreYamlParser::parseFastIntern(const unsigned char* p, const unsigned char* end, QoreValue& rv) {
+    ValueHolder root(xsink);
+    std::vector<QoreYamlFastFrame> stack;
+    // decoded scalar values and NUL-terminated copies of values
+    std::string buf;
+    // the current hash key
+    std::string key_tmp;
+    const char* key = nullptr;
+    // the resolved tag of the current scalar
+    std::string tag;
+
+    total_bytes = total_nodes = 0;
+
+    while (true) {
+        // parse a node
+        QoreValue v;
+        QoreListNode* l = nullptr;
+        QoreHashNode* h = nullptr;
+        bool container = (*p == '[' || *p == '{');
+        if (container) {
+            if (has_limits && ((limits.max_depth && stack.size() >= limits.max_depth)
+                || !fastCount(YAML_NODE_SIZE))) {
+                return false;
+            }
+            if (*p == '[') {
+                v = l = new QoreListNode(autoTypeInfo);
+            } else {
+                v = h = new QoreHashNode(autoTypeInfo);
+            }
+            ++p;
+        } else {
+            p = parseFastScalar(p, end, !stack.empty(), buf, tag, v);
+            if (!p) {
+                return false;
+            }
+        }
+
+        if (stack.empty()) {
+            root = v;
+        } else if (stack.back().l) {
+            stack.back().l->push(v, nullptr);
+        } else {
+            stack.back().h->setKeyValue(key, v, xsink);
+            if (*xsink) {
+                return false;
+            }
+        }
+
+        bool expect_key = false;
+        if (container) {
+            stack.push_back({l, h});
+            p = yaml_fast_skip_spaces(p, end);
+            if (p == end) {
+                return false;
+            }
+            if (*p != (l ? ']' : '}')) {
+                if (l) {
+                    continue;
+                }
+                expect_key = true;
+            }
+        }
+
+        // find the next node or key, closing collections
+        while (!expect_key) {
+            p = yaml_fast_skip_spaces(p, end);
+            if (stack.empty()) {
+                break;
+            }
+            if (p == end) {
+                return false;
+            }
+            if (*p == ',') {
+                p = yaml_fast_skip_spaces(p + 1, end);
+                if (p == end) {
+                    return false;
+                }
+                if (stack.back().l) {
+                    break;
+                }
+                expect_key = true;
+                break;
+            }
+            if (*p != (stack.back().l ? ']' : '}')) {
+                return false;
+            }
+            ++p;
+            stack.pop_back();
+        }
+
+        if (expect_key) {
+            p = parseFastKey(p, end, buf, key_tmp, key);
+            if (!p) {
+                return false;
+            }
+            continue;
+        }
+
+        if (stack.empty()) {
+            break;
+        }
+    }
+
+    // the document must end with the line of the root node and an optional document end marker
+    if (p < end) {
+        if (*p != '\n') {
+            return false;
+        }
+        ++p;
+        if (p < end && !((end - p == 3 || (end - p == 4 && p[3] == '\n')) && !memcmp(p, "...", 3))) {
+            return false;
+        }
+    }
+
+    rv = root.release();
+    return true;
+}
+
+// updates the running totals for a new node; returns false if a limit has been exceeded
+bool QoreYamlParser::fastCount(size_t size) {
+    if (limits.max_nodes && ++total_nodes > limits.max_nodes) {
+        return false;
+    }
+    total_bytes += size;
+    return !limits.max_bytes || total_bytes <= limits.max_bytes;
+}
+
+// parses an untagged scalar mapping key and the following value indicator
+const unsigned char* QoreYamlParser::parseFastKey(const unsigned char* p, const unsigned char* end, std::string& buf,
+        std::string& key_tmp, const char*& key) {
+    const unsigned char* start = p;
+    const char* val;
+    size_t len;
+    bool decoded = false;
+    if (*p == '"' || *p == '\'') {
+        const unsigned char* vp = p + 1;
+        p = *p == '"' ? yaml_fast_scan_double(vp, end, buf, decoded) : yaml_fast_scan_single(vp, end, buf, decoded);
+        if (!p) {
+            return nullptr;
+        }
+        val = decoded ? buf.c_str() : (const char*)vp;
+        len = decoded ? buf.size() : p - vp - 1;
+        p = yaml_fast_skip_spaces(p, end);
+    } else {
+        const unsigned char* e = yaml_fast_scan_plain(p, end, true);
+        if (!e) {
+            return nullptr;
+        }
+        val = (const char*)p;
+        len = e - p;
+        p = yaml_fast_skip_spaces(e, end);
+    }
+
+    // libyaml only allows implicit keys up to 1024 characters long
+    if (p + 1 >= end || *p != ':' || p[1] != ' ' || p - start > 1000) {
+        return nullptr;
+    }
+    if (has_limits && ((limits.max_scalar_len && len > limits.max_scalar_len) || !fastCount(YAML_NODE_SIZE + len))) {
+        return nullptr;
+    }
+
+    key = getKey(val, len, key_tmp);
+    if (!key) {
+        return nullptr;
+    }
+    return yaml_fast_skip_spaces(p + 2, end);
+}
+
+// parses a scalar with an optional tag; returns a pointer after the scalar or nullptr if the scalar is not supported
+const unsigned char* QoreYamlParser::parseFastScalar(const unsigned char* p, const unsigned char* end, bool flow,
+        std::string& buf, std::string& tag, QoreValue& v) {
+    const char* tag_str = nullptr;
+    qore_yaml_tag_e tag_type = QYT_STR;
+    if (*p == '!') {
+        // only tags with the primary or secondary handle and a simple suffix are supported
+        const unsigned char* ts = p + 1;
+        bool secondary = (ts < end && *ts == '!');
+        if (secondary) {
+            ++ts;
+        }
+        const unsigned char* te = ts;
+        while (te < end && (isalnum(*te) || *te == '-')) {
+            ++te;
+        }
+        if (te == ts || te + 1 >= end || *te != ' ') {
+            return nullptr;
+        }
+        tag.assign(secondary ? YAML_FAST_SECONDARY_PREFIX : "!");
+        tag.append((const char*)ts, te - ts);
+        tag_map_t::const_iterator i = tag_map.find(tag.c_str());
+        if (i == tag_map.end()) {
+            return nullptr;
+        }
+        tag_str = tag.c_str();
+        tag_type = i->second;
+        p = te + 1;
+    }
+
+    const char* val;
+    size_t len;
+    yaml_scalar_style_t style;
+    bool decoded = false;
+    if (*p == '"' || *p == '\'') {
+        const unsigned char* vp = p + 1;
+        if (*p == '"') {
+            style = YAML_DOUBLE_QUOTED_SCALAR_STYLE;
+            p = yaml_fast_scan_double(vp, end, buf, decoded);
+        } else {
+            style = YAML_SINGLE_QUOTED_SCALAR_STYLE;
+            p = yaml_fast_scan_single(vp, end, buf, decoded);
+        }
+        if (!p) {
+            return nullptr;
+        }
+        val = (const char*)vp;
+        len = p - vp - 1;
+    } else {
+        style = YAML_PLAIN_SCALAR_STYLE;
+        const unsigned char* e = yaml_fast_scan_plain(p, end, flow);
+        if (!e) {
+            return nullptr;
+        }
+        val = (const char*)p;
+        len = e - p;
+        p = e;
+    }
+
+    if (decoded) {
+        val = buf.c_str();
+        len = buf.size();
+    } else if ((tag_str || style != YAML_DOUBLE_QUOTED_SCALAR_STYLE) && tag_type != QYT_BINARY) {
+        // the value must be NUL-terminated to be converted
+        buf.assign(val, len);
+        val = buf.c_str();
+    }
+
+    if (has_limits && ((limits.max_scalar_len && len > limits.max_scalar_len) || !fastCount(YAML_NODE_SIZE + len))) {
+        return nullptr;
+    }
+
+    // the value is converted from a scalar event as if it had been returned by libyaml
+    event.type = YAML_SCALAR_EVENT;
+    event.data.scalar.anchor = nullptr;
+    event.data.scalar.tag = (yaml_char_t*)tag_str;
+    event.data.scalar.value = (yaml_char_t*)val;
+    event.data.scalar.length = len;
+    event.data.scalar.plain_implicit = !tag_str && style == YAML_PLAIN_SCALAR_STYLE;
+    event.data.scalar.quoted_implicit = !tag_str && style != YAML_PLAIN_SCALAR_STYLE;
+    event.data.scalar.style = style;
+    v = parseScalar();
+    if (*xsink) {
+        return nullptr;
+    }
+    return p;
+}
@@ -0,0 +1,714 @@
+/* indent-tabs-mode: nil -*- */
+/*
+    yaml Qore module
+
+    Copyright (C) 2010 - 2022 Qore Technologies, s.r.o.
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "yaml-module.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include <cmath>
+
+// the styles allowed for scalars that never need quoting, such as integers and booleans
+static const QoreYamlScalarInfo yaml_plain_info;
+
+static const char yaml_hex_digits[] = "0123456789ABCDEF";
+
+// returns the width of the UTF-8 character starting with the given byte, 0 if the byte is invalid
+static inline unsigned yaml_utf8_width(unsigned char c) {
+    return (c & 0x80) == 0 ? 1 : (c & 0xe0) == 0xc0 ? 2 : (c & 0xf0) == 0xe0 ? 3 : (c & 0xf8) == 0xf0 ? 4 : 0;
+}
+
+// returns the byte at the given offset or 0 if the offset is past the end
+static inline unsigned char yaml_at(const unsigned char* p, const unsigned char* end, size_t i) {
+    return p + i < end ? p[i] : 0;
+}
+
+// the following character class tests are the same as the ones used by libyaml
+
+static inline bool yaml_is_printable(const unsigned char* p, const unsigned char* end) {
+    unsigned char c = p[0];
+    return c == 0x0a || (c >= 0x20 && c <= 0x7e)
+        || (c == 0xc2 && yaml_at(p, end, 1) >= 0xa0)
+        || (c > 0xc2 && c < 0xed)
+        || (c == 0xed && yaml_at(p, end, 1) < 0xa0)
+        || c == 0xee
+        || (c == 0xef && !(yaml_at(p, end, 1) == 0xbb && yaml_at(p, end, 2) == 0xbf)
+            && !(yaml_at(p, end, 1) == 0xbf && (yaml_at(p, end, 2) == 0xbe || yaml_at(p, end, 2) == 0xbf)));
+}
+
+static inline bool yaml_char_is_break(const unsigned char* p, const unsigned char* end) {
+    unsigned char c = p[0];
+    return c == '\r' || c == '\n' || (c == 0xc2 && yaml_at(p, end, 1) == 0x85)
+        || (c == 0xe2 && yaml_at(p, end, 1) == 0x80
+            && (yaml_at(p, end, 2) == 0xa8 || yaml_at(p, end, 2) == 0xa9));
+}
+
+static inline bool yaml_is_blankz(const unsigned char* p, const unsigned char* end) {
+    return p >= end || !*p || *p == ' ' || *p == '\t' || yaml_char_is_break(p, end);
+}
+
+// returns 0 if the value is valid UTF-8 as checked by libyaml for scalar events, -1 if not
+static int yaml_check_utf8(const char* value, size_t size) {
+    const unsigned char* p = (const unsigned char*)value;
+    const unsigned char* end = p + size;
+    while (p < end) {
+        unsigned w = yaml_utf8_width(*p);
+        if (!w || p + w > end) {
+            return -1;
+        }
+        unsigned v = *p & (w == 1 ? 0x7f : w == 2 ? 0x1f : w == 3 ? 0x0f : 0x07);
+        for (unsigned k = 1; k < w; ++k) {
+            if ((p[k] & 0xc0) != 0x80) {
+                return -1;
+            }
+            v = (v << 6) + (p[k] & 0x3f);
+        }
+        // reject overlong encodings
+        if (!(w == 1 || (w == 2 && v >= 0x80) || (w == 3 && v >= 0x800) || (w == 4 && v >= 0x10000))) {
+            return -1;
+        }
+        p += w;
+    }
+    return 0;
+}
+
+// returns the number of UTF-8 characters in the value
+static size_t yaml_count_chars(const char* value, size_t size) {
+    size_t n = 0;
+    for (const unsigned char* p = (const unsigned char*)value, * end = p + size; p < end; ++p) {
+        if ((*p & 0xc0) != 0x80) {
+            ++n;
+        }
+    }
+    return n;
+}
+
+// determines the styles allowed for the scalar in the same way as yaml_emitter_analyze_scalar()
+static void yaml_analyze_scalar(const char* value, size_t size, bool unicode, QoreYamlScalarInfo& info) {
+    if (!size) {
+        info.multiline = false;
+        info.flow_plain_allowed = false;
+        info.block_plain_allowed = true;
+        info.single_quoted_allowed = true;
+        return;
+    }
+
+    const unsigned char* start = (const unsigned char*)value;
+    const unsigned char* end = start + size;
+
+    bool block_indicators = false,
+        flow_indicators = false,
+        line_breaks = false,
+        special_characters = false,
+        leading_space = false,
+        leading_break = false,
+        trailing_space = false,
+        trailing_break = false,
+        break_space = false,
+        space_break = false,
+        previous_space = false,
+        previous_break = false;
+
+    if ((start[0] == '-' && yaml_at(start, end, 1) == '-' && yaml_at(start, end, 2) == '-')
+        || (start[0] == '.' && yaml_at(start, end, 1) == '.' && yaml_at(start, end, 2) == '.')) {
+        block_indicators = flow_indicators = true;
+    }
+
+    bool preceded_by_whitespace = true;
+    bool followed_by_whitespace = yaml_is_blankz(start + yaml_utf8_width(*start), end);
+
+    const unsigned char* p = start;
+    while (p < end) {
+        unsigned char c = *p;
+        if (p == start) {
+            switch (c) {
+                case '#': case ',': case '[': case ']': case '{': case '}': case '&': case '*': case '!':
+                case '|': case '>': case '\'': case '"': case '%': case '@': case '`':
+                    flow_indicators = block_indicators = true;
+                    break;
+
+                case '?': case ':':
+                    flow_indicators = true;
+                    if (followed_by_whitespace) {
+                        block_indicators = true;
+                    }
+                    break;
+
+                case '-':
+                    if (followed_by_whitespace) {
+                        flow_indicators = block_indicators = true;
+                    }
+                    break;
+            }
+        } else {
+            switch (c) {
+                case ',': case '?': case '[': case ']': case '{': case '}':
+                    flow_indicators = true;
+                    break;
+
+                case ':':
+                    flow_indicators = true;
+                    if (followed_by_whitespace) {
+                        block_indicators = true;
+                    }
+                    break;
+
+                case '#':
+                    if (preceded_by_whitespace) {
+                        flow_indicators = block_indicators = true;
+                    }
+                    break;
+            }
+        }
+
+        if (!yaml_is_printable(p, end) || (c > 0x7f && !unicode)) {
+            special_characters = true;
+        }
+
+        unsigned w = yaml_utf8_width(c);
+        if (c == ' ') {
+            if (p == start) {
+                leading_space = true;
+            }
+            if (p + w == end) {
+                trailing_space = true;
+            }
+            if (previous_break) {
+                break_space = true;
+            }
+            previous_space = true;
+            previous_break = false;
+        } else if (yaml_char_is_break(p, end)) {
+            line_breaks = true;
+            if (p == start) {
+                leading_break = true;
+            }
+            if (p + w == end) {
+                trailing_break = true;
+            }
+            if (previous_space) {
+                space_break = true;
+            }
+            previous_space = false;
+            previous_break = true;
+        } else {
+            previous_space = previous_break = false;
+        }
+
+        preceded_by_whitespace = yaml_is_blankz(p, end);
+        p += w;
+        if (p < end) {
+            followed_by_whitespace = yaml_is_blankz(p + yaml_utf8_width(*p), end);
+        }
+    }
+
+    info.multiline = line_breaks;
+    info.flow_plain_allowed = info.block_plain_allowed = info.single_quoted_allowed = true;
+    if (leading_space || leading_break || trailing_space || trailing_break || line_breaks) {
+        info.flow_plain_allowed = info.block_plain_allowed = false;
+    }
+    if (break_space || space_break || special_characters) {
+        info.flow_plain_allowed = info.block_plain_allowed = info.single_quoted_allowed = false;
+    }
+    if (flow_indicators) {
+        info.flow_plain_allowed = false;
+    }
+    if (block_indicators) {
+        info.block_plain_allowed = false;
+    }
+}
+
+QoreYamlNativeEmitter::QoreYamlNativeEmitter(QoreYamlWriteHandler& wh, int flags, int indent,
+        ExceptionSink* xsink) : QoreYamlEmitterBase(xsink), wh(wh),
+        best_indent(indent < 2 || indent > 9 ? 2 : indent),
+        block(flags & QYE_BLOCK_STYLE),
+        unicode(!(flags & QYE_ESCAPE_UNICODE)),
+        implicit_start_doc(!(flags & QYE_EXPLICIT_START_DOC)),
+        implicit_end_doc(!(flags & QYE_EXPLICIT_END_DOC)),
+        emit_sqlnull(flags & QYE_EMIT_SQLNULL) {
+    assert(supported(flags, -1));
+    valid = true;
+    docStart();
+}
+
+int QoreYamlNativeEmitter::emit(const QoreValue& v) {
+    switch (v.getType()) {
+        case NT_STRING:
+            return emitValue(*v.get<const QoreStringNode>());
+
+        case NT_INT: {
+            char tmp[YAML_NUMBER_BUFFER_SIZE];
+            size_t len = formatValue(v.getAsBigInt(), tmp);
+            writeScalar(tmp, len, QYS_ANY, nullptr, nullptr, &yaml_plain_info);
+            break;
+        }
+
+        case NT_FLOAT: {
+            char tmp[YAML_NUMBER_BUFFER_SIZE];
+            double f = v.getAsFloat();
+            size_t len = formatValue(f, tmp);
+            // "@inf@" and "@nan@" start with an indicator and are quoted
+            writeScalar(tmp, len, QYS_ANY, nullptr, nullptr, std::isfinite(f) ? &yaml_plain_info : nullptr);
+            break;
+        }
+
+        case NT_NUMBER: {
+            QoreString tmp(QCS_UTF8);
+            formatValue(*v.get<const QoreNumberNode>(), tmp);
+            // the tag is written with the default "!" handle
+            writeScalar(tmp.c_str(), tmp.size(), QYS_ANY, "!", "number");
+            break;
+        }
+
+        case NT_BOOLEAN:
+            if (v.getAsBool()) {
+                writeScalar("true", 4, QYS_ANY, nullptr, nullptr, &yaml_plain_info);
+            } else {
+                writeScalar("false", 5, QYS_ANY, nullptr, nullptr, &yaml_plain_info);
+            }
+            break;
+
+        case NT_LIST:
+            return emitValue(*v.get<const QoreListNode>());
+
+        case NT_HASH:
+            return emitValue(*v.get<const QoreHashNode>());
+
+        case NT_DATE: {
+            char tmp[YAML_DATE_BUFFER_SIZE];
+            const char* tag;
+            size_t len = formatValue(*v.get<const DateTimeNode>(), false, tmp, tag);
+            writeScalar(tmp, len, QYS_ANY);
+            break;
+        }
+
+        case NT_BINARY:
+            return emitValue(*v.get<const BinaryNode>());
+
+        case NT_NULL:
+            if (emit_sqlnull) {
+                writeScalar(SqlNullStr.c_str(), SqlNullStr.size(), QYS_ANY, nullptr, nullptr, &yaml_plain_info);
+                break;
+            }
+            // fall down to nothing
+
+        case NT_NOTHING:
+            writeScalar(NullStr.c_str(), NullStr.size(), QYS_ANY, nullptr, nullptr, &yaml_plain_info);
+            break;
+
+        default:
+            return err("cannot convert Qore type '%s' to YAML", v.getTypeName());
+    }
+
+    return valid ? 0 : -1;
+}
+
+int QoreYamlNativeEmitter::emitValue(const QoreString& value) {
+    TempEncodingHelper str(value, QCS_UTF8, xsink);
+    if (*xsink) {
+        valid = false;
+        return -1;
+    }
+
+    if (yaml_check_utf8(str->c_str(), str->size())) {
+        return doScalarEmissionError(**str, YAML_STR_TAG);
+    }
+
+    writeScalar(str->c_str(), str->size(), QYS_DOUBLE_QUOTED);
+    return valid ? 0 : -1;
+}
+
+int QoreYamlNativeEmitter::emitValue(const QoreListNode& l) {
+    int saved_indent = indent;
+    if (flow_level || !block || l.empty()) {
+        writeIndicator("[", 1, true, true, false);
+        increaseIndent(true, false);
+        ++flow_level;
+        bool first = true;
+        ConstListIterator li(l);
+        while (li.next()) {
+            if (first) {
+                first = false;
+            } else {
+                writeIndicator(",", 1, false, false, false);
+            }
+            setContext(false, true, false, false);
+            if (emit(li.getValue())) {
+                return -1;
+            }
+        }
+        --flow_level;
+        indent = saved_indent;
+        writeIndicator("]", 1, false, false, false);
+        return 0;
+    }
+
+    // block sequences in a mapping are not indented
+    increaseIndent(false, mapping_context && !indention);
+    ConstListIterator li(l);
+    while (li.next()) {
+        writeIndent();
+        writeIndicator("-", 1, true, false, true);
+        setContext(false, true, false, false);
+        if (emit(li.getValue())) {
+            return -1;
+        }
+    }
+    indent = saved_indent;
+    return 0;
+}
+
+int QoreYamlNativeEmitter::emitValue(const QoreHashNode& h) {
+    int saved_indent = indent;
+    bool flow = flow_level || !block || h.empty();
+    if (flow) {
+        writeIndicator("{", 1, true, true, false);
+        increaseIndent(true, false);
+        ++flow_level;
+    } else {
+        increaseIndent(false, false);
+    }
+
+    bool first = true;
+    ConstHashIterator hi(h);
+    while (hi.next()) {
+        const char* key = hi.getKey();
+        size_t key_len = strlen(key);
+        if (yaml_check_utf8(key, key_len)) {
+            QoreString tmp(key);
+            return doScalarEmissionError(tmp, YAML_STR_TAG);
+        }
+
+        if (flow) {
+            if (first) {
+                first = false;
+            } else {
+                writeIndicator(",", 1, false, false, false);
+            }
+        } else {
+            writeIndent();
+        }
+
+        QoreYamlScalarInfo info;
+        yaml_analyze_scalar(key, key_len, unicode, info);
+        // libyaml writes keys that are longer than 128 bytes or span lines as complex keys with "?"
+        if (!info.multiline && key_len <= 128) {
+            setContext(false, false, true, true);
+            writeScalar(key, key_len, QYS_ANY, nullptr, nullptr, &info);
+            writeIndicator(":", 1, false, false, false);
+        } else {
+            writeIndicator("?", 1, true, false, !flow);
+            setContext(false, false, true, false);
+            writeScalar(key, key_len, QYS_ANY, nullptr, nullptr, &info);
+            if (flow) {
+                writeIndicator(":", 1, true, false, false);
+            } else {
+                writeIndent();
+                writeIndicator(":", 1, true, false, true);
+            }
+        }
+
+        setContext(false, false, true, false);
+        if (emit(hi.get())) {
+            return -1;
+        }
+    }
+
+    indent = saved_indent;
+    if (flow) {
+        --flow_level;
+        writeIndicator("}", 1, false, false, false);
+    }
+    return 0;
+}
+
+int QoreYamlNativeEmitter::emitValue(const BinaryNode& b) {
+    QoreString str(QCS_UTF8);
+    q_yaml_base64_encode(b.getPtr(), b.size(), str);
+    // the tag is written with the default "!!" handle for "tag:yaml.org,2002:"
+    writeScalar(str.c_str(), str.size(), QYS_DOUBLE_QUOTED, "!!", "binary");
+    return valid ? 0 : -1;
+}
+
+int QoreYamlNativeEmitter::emitDocuments(const QoreListNode& l) {
+    ConstListIterator li(l);
+    while (li.next()) {
+        if (li.index()) {
+            docEnd();
+            docStart(false);
+        }
+        if (emitRoot(li.getValue())) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+void QoreYamlNativeEmitter::docStart(bool first) {
+    // libyaml always writes the marker for documents after the first one
+    if (!implicit_start_doc || !first) {
+        writeIndent();
+        writeIndicator("---", 3, true, false, false);
+    }
+}
+
+void QoreYamlNativeEmitter::docEnd() {
+    writeIndent();
+    if (!implicit_end_doc) {
+        writeIndicator("...", 3, true, false, false);
+        writeIndent();
+    }
+}
+
+void QoreYamlNativeEmitter::streamEnd() {
+    flush();
+}
+
+void QoreYamlNativeEmitter::writeScalar(const char* value, size_t size, QoreYamlScalarStyle style,
+        const char* tag_handle, const char* tag_suffix, const QoreYamlScalarInfo* info) {
+    if (style == QYS_ANY) {
+        QoreYamlScalarInfo tmp;
+        if (!info) {
+            yaml_analyze_scalar(value, size, unicode, tmp);
+            info = &tmp;
+        }
+        if (simple_key_context && info->multiline) {
+            style = QYS_DOUBLE_QUOTED;
+        } else if ((flow_level ? !info->flow_plain_allowed : !info->block_plain_allowed)
+            || (!size && (flow_level || simple_key_context))) {
+            style = info->single_quoted_allowed ? QYS_SINGLE_QUOTED : QYS_DOUBLE_QUOTED;
+        }
+    }
+
+    if (tag_handle) {
+        writeTag(tag_handle, tag_suffix);
+    }
+
+    int saved_indent = indent;
+    increaseIndent(true, false);
+    switch (style) {
+        case QYS_ANY:
+            writePlain(value, size);
+            break;
+        case QYS_SINGLE_QUOTED:
+            writeSingleQuoted(value, size);
+            break;
+        case QYS_DOUBLE_QUOTED:
+            writeDoubleQuoted(value, size);
+            break;
+    }
+    indent = saved_indent;
+}
+
+void QoreYamlNativeEmitter::writePlain(const char* value, size_t size) {
+    // plain scalars never contain line breaks
+    if (!whitespace && (size || flow_level)) {
+        put(' ');
+    }
+    write(value, size, yaml_count_chars(value, size));
+    whitespace = false;
+    indention = false;
+}
+
+void QoreYamlNativeEmitter::writeSingleQuoted(const char* value, size_t size) {
+    writeIndicator("'", 1, true, false, false);
+
+    const unsigned char* p = (const unsigned char*)value;
+    const unsigned char* end = p + size;
+    bool breaks = false;
+    while (p < end) {
+        if (*p == ' ') {
+            put(' ');
+            ++p;
+        } else if (yaml_char_is_break(p, end)) {
+            if (*p == '\n') {
+                if (!breaks) {
+                    putBreak();
+                }
+                putBreak();
+                ++p;
+            } else {
+                unsigned w = yaml_utf8_width(*p);
+                write((const char*)p, w, 0);
+                column = 0;
+                p += w;
+            }
+            indention = true;
+            breaks = true;
+        } else {
+            if (breaks) {
+                writeIndent();
+            }
+            if (*p == '\'') {
+                put('\'');
+            }
+            unsigned w = yaml_utf8_width(*p);
+            write((const char*)p, w, 1);
+            p += w;
+            indention = false;
+            breaks = false;
+        }
+    }
+    if (breaks) {
+        writeIndent();
+    }
+
+    writeIndicator("'", 1, false, false, false);
+    whitespace = false;
+    indention = false;
+}
+
+void QoreYamlNativeEmitter::writeDoubleQuoted(const char* value, size_t size) {
+    writeIndicator("\"", 1, true, false, false);
+
+    const unsigned char* p = (const unsigned char*)value;
+    const unsigned char* end = p + size;
+    while (p < end) {
+        // copy runs of printable ASCII characters that are not escaped
+        const unsigned char* start = p;
+        while (p < end && *p >= 0x20 && *p <= 0x7e && *p != '"' && *p != '\\') {
+            ++p;
+        }
+        if (p != start) {
+            write((const char*)start, p - start, p - start);
+            if (p == end) {
+                break;
+            }
+        }
+
+        unsigned char c = *p;
+        unsigned w = yaml_utf8_width(c);
+        if (c > 0x7f && unicode && yaml_is_printable(p, end) && !yaml_char_is_break(p, end)) {
+            write((const char*)p, w, 1);
+            p += w;
+            continue;
+        }
+
+        unsigned v = c & (w == 1 ? 0x7f : w == 2 ? 0x1f : w == 3 ? 0x0f : 0x07);
+        for (unsigned k = 1; k < w; ++k) {
+            v = (v << 6) + (p[k] & 0x3f);
+        }
+        p += w;
+
+        put('\\');
+        switch (v) {
+            case 0x00: put('0'); break;
+            case 0x07: put('a'); break;
+            case 0x08: put('b'); break;
+            case 0x09: put('t'); break;
+            case 0x0a: put('n'); break;
+            case 0x0b: put('v'); break;
+            case 0x0c: put('f'); break;
+            case 0x0d: put('r'); break;
+            case 0x1b: put('e'); break;
+            case 0x22: put('"'); break;
+            case 0x5c: put('\\'); break;
+            case 0x85: put('N'); break;
+            case 0xa0: put('_'); break;
+            case 0x2028: put('L'); break;
+            case 0x2029: put('P'); break;
+            default: {
+                int digits;
+                if (v <= 0xff) {
+                    put('x');
+                    digits = 2;
+                } else if (v <= 0xffff) {
+                    put('u');
+                    digits = 4;
+                } else {
+                    put('U');
+                    digits = 8;
+                }
+                for (int k = (digits - 1) * 4; k >= 0; k -= 4) {
+                    put(yaml_hex_digits[(v >> k) & 0xf]);
+                }
+                break;
+            }
+        }
+    }
+
+    writeIndicator("\"", 1, false, false, false);
+    whitespace = false;
+    indention = false;
+}
+
+void QoreYamlNativeEmitter::writeTag(const char* handle, const char* suffix) {
+    if (!whitespace) {
+        put(' ');
+    }
+    size_t size = strlen(handle);
+    write(handle, size, size);
+    size = strlen(suffix);
+    write(suffix, size, size);
+    whitespace = false;
+    indention = false;
+}
+
+void QoreYamlNativeEmitter::writeIndicator(const char* ind, size_t size, bool need_whitespace, bool is_whitespace,
+        bool is_indention) {
+    if (need_whitespace && !whitespace) {
+        put(' ');
+    }
+    write(ind, size, size);
+    whitespace = is_whitespace;
+    indention = indention && is_indention;
+}
+
+void QoreYamlNativeEmitter::writeIndent() {
+    int i = indent >= 0 ? indent : 0;
+    if (!indention || column > i || (column == i && !whitespace)) {
+        putBreak();
+    }
+    while (column < i) {
+        put(' ');
+    }
+    whitespace = true;
+    indention = true;
+}
+
+void QoreYamlNativeEmitter::write(const char* p, size_t size, size_t chars) {
+    column += chars;
+    while (size) {
+        if (len == YAML_NATIVE_BUFFER_SIZE) {
+            flush();
+        }
+        size_t n = YAML_NATIVE_BUFFER_SIZE - len;
+        if (n > size) {
+            n = size;
+        }
+        memcpy(buf + len, p, n);
+        len += n;
+        p += n;
+        size -= n;
+    }
+}
+
+void QoreYamlNativeEmitter::flush() {
+    if (len && valid && !wh.write((unsigned char*)buf, len)) {
+        // do not mask exceptions raised by the write handler
+        if (*xsink) {
+            valid = false;
+        } else {
+            err("error writing yaml output");
+        }
+    }
+    len = 0;
+}
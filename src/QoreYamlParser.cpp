@@ -22,10 +22,13 @@
 #include "yaml-module.h"
 
 #include <stdlib.h>
+#include <string.h>
 #include <ctype.h>
 #include <errno.h>
 #include <strings.h>
 #include <math.h>
+#include <float.h>
+#include <stdint.h>
 
 const char* QY_PARSE_ERR = "YAML-PARSER-ERROR";
 
@@ -33,7 +36,165 @@ static const char* invalid_date_format = "invalid date format";
 static const char* truncated_date = "invalid date format; input truncated";
 static const char* invalid_chars_after_time = "invalid characters after time value";
 
+static int qore_yaml_read_handler(QoreYamlReadHandler* rh, unsigned char* buffer, size_t size, size_t* size_read) {
+    return rh->read(buffer, size, size_read);
+}
+
+#ifdef QORE_YAML_CONTEXT_CACHE
+namespace {
+// a libyaml parser context cached by each thread
+struct QoreYamlParserCache {
+    yaml_parser_t parser;
+    bool set = false;
+
+    DLLLOCAL ~QoreYamlParserCache() {
+        if (set) {
+            yaml_parser_delete(&parser);
+        }
+    }
+};
+}
+
+static thread_local QoreYamlParserCache yaml_parser_cache;
+#endif
+
+int q_yaml_parser_acquire(yaml_parser_t& p) {
+#ifdef QORE_YAML_CONTEXT_CACHE
+    if (yaml_parser_cache.set) {
+        memcpy(&p, &yaml_parser_cache.parser, sizeof p);
+        yaml_parser_cache.set = false;
+        return 1;
+    }
+#endif
+    return yaml_parser_initialize(&p);
+}
+
+void q_yaml_parser_release(yaml_parser_t& p) {
+#ifndef QORE_YAML_CONTEXT_CACHE
+    yaml_parser_delete(&p);
+#else
+    // contexts whose stacks have grown for deeply-nested input are not kept
+    if (yaml_parser_cache.set || !p.buffer.start || q_yaml_stack_bytes(p.tokens) > YAML_CONTEXT_MAX_STACK
+        || q_yaml_stack_bytes(p.indents) > YAML_CONTEXT_MAX_STACK
+        || q_yaml_stack_bytes(p.simple_keys) > YAML_CONTEXT_MAX_STACK
+        || q_yaml_stack_bytes(p.states) > YAML_CONTEXT_MAX_STACK
+        || q_yaml_stack_bytes(p.marks) > YAML_CONTEXT_MAX_STACK
+        || q_yaml_stack_bytes(p.tag_directives) > YAML_CONTEXT_MAX_STACK) {
+        yaml_parser_delete(&p);
+        return;
+    }
+
+    // free data left by an incomplete parse as yaml_parser_delete() does
+    while (p.tokens.head != p.tokens.tail) {
+        yaml_token_delete(p.tokens.head++);
+    }
+    while (p.tag_directives.top != p.tag_directives.start) {
+        --p.tag_directives.top;
+        free(p.tag_directives.top->handle);
+        free(p.tag_directives.top->prefix);
+    }
+
+    // reset the state as yaml_parser_initialize() does, keeping the allocated buffers and stacks; this assumes the
+    // yaml_parser_t layout and initial state of libyaml 0.2.1 - 0.2.5, which is checked when the module is configured
+    yaml_parser_t& c = yaml_parser_cache.parser;
+    memset(&c, 0, sizeof c);
+    c.buffer.start = c.buffer.pointer = c.buffer.last = p.buffer.start;
+    c.buffer.end = p.buffer.end;
+    c.raw_buffer.start = c.raw_buffer.pointer = c.raw_buffer.last = p.raw_buffer.start;
+    c.raw_buffer.end = p.raw_buffer.end;
+    c.tokens.start = c.tokens.head = c.tokens.tail = p.tokens.start;
+    c.tokens.end = p.tokens.end;
+    c.indents.start = c.indents.top = p.indents.start;
+    c.indents.end = p.indents.end;
+    c.simple_keys.start = c.simple_keys.top = p.simple_keys.start;
+    c.simple_keys.end = p.simple_keys.end;
+    c.states.start = c.states.top = p.states.start;
+    c.states.end = p.states.end;
+    c.marks.start = c.marks.top = p.marks.start;
+    c.marks.end = p.marks.end;
+    c.tag_directives.start = c.tag_directives.top = p.tag_directives.start;
+    c.tag_directives.end = p.tag_directives.end;
+    yaml_parser_cache.set = true;
+#endif
+}
+
+// returns 0 if the input can be parsed by libyaml, -1 if an exception was raised
+static int yaml_check_bom(const unsigned char* data, size_t len, ExceptionSink* xsink) {
+    if (len >= 4 && ((!data[0] && !data[1] && data[2] == 0xfe && data[3] == 0xff)
+        || (data[0] == 0xff && data[1] == 0xfe && !data[2] && !data[3]))) {
+        xsink->raiseException(QY_PARSE_ERR, "UTF-32 encoded YAML input is not supported");
+        return -1;
+    }
+    // a UTF-16 byte order mark is detected by libyaml
+    if (len >= 2 && ((data[0] == 0xff && data[1] == 0xfe) || (data[0] == 0xfe && data[1] == 0xff))) {
+        return 0;
+    }
+    // UTF-16 and UTF-32 without a byte order mark cannot be detected by libyaml
+    if (len >= 2 && (!data[0] || !data[1])) {
+        xsink->raiseException(QY_PARSE_ERR, "YAML input appears to be UTF-16 or UTF-32 encoded without a byte order "
+            "mark");
+        return -1;
+    }
+    return 0;
+}
+
+QoreYamlParser::QoreYamlParser(const void* data, size_t len, ExceptionSink* xsink) : QoreYamlBase(xsink),
+        discard(false) {
+    q_yaml_parser_acquire(parser);
+    if (yaml_check_bom((const unsigned char*)data, len, xsink)) {
+        return;
+    }
+    // the encoding is set by libyaml from the byte order mark, if any, otherwise UTF-8 is assumed
+    yaml_parser_set_input_string(&parser, (const unsigned char*)data, len);
+    fast_data = (const char*)data;
+    fast_len = len;
+    valid = true;
+}
+
+QoreYamlParser::QoreYamlParser(QoreYamlReadHandler& rh, ExceptionSink* xsink) : QoreYamlBase(xsink), discard(false) {
+    q_yaml_parser_acquire(parser);
+    yaml_parser_set_input(&parser, (yaml_read_handler_t*)qore_yaml_read_handler, &rh);
+    valid = true;
+}
+
+bool QoreYamlParser::inputEnded() const {
+    if (parser.error == YAML_NO_ERROR || !fast_data)
+        return false;
+
+    // find the line and column of the end of the input without trailing whitespace
+    const char* end = fast_data + fast_len;
+    while (end > fast_data && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r' || end[-1] == '\n'))
+        --end;
+    size_t line = 0;
+    const char* line_start = fast_data;
+    for (const char* p = fast_data; p < end; ++p) {
+        if (*p == '\n') {
+            ++line;
+            line_start = p + 1;
+        }
+    }
+    // libyaml counts columns in characters
+    size_t column = 0;
+    for (const char* p = line_start; p < end; ++p) {
+        if ((*p & 0xc0) != 0x80)
+            ++column;
+    }
+
+    const yaml_mark_t& mark = parser.problem_mark;
+    return mark.line > line || (mark.line == line && mark.column >= column);
+}
+
 QoreValue QoreYamlParser::parse() {
+    if (!valid)
+        return QoreValue();
+
+    // most input is written by make_yaml() and can be parsed without libyaml
+    if (fast_data && type_tmpl.isNothing()) {
+        QoreValue v;
+        if (parseFast(v))
+            return v;
+    }
+
     ValueHolder rv(xsink);
 
     if (getCheckEvent(YAML_STREAM_START_EVENT))
@@ -47,7 +208,9 @@ QoreValue QoreYamlParser::parse() {
             return QoreValue();
 
         if (event.type != YAML_DOCUMENT_END_EVENT) {
-            rv = parseNode();
+            rv = type_tmpl.isNothing() ? parseNode() : parseTypedNode(nullptr, type_tmpl);
+            if (!keep_anchors)
+                clearAnchors();
             if (*xsink)
                 return QoreValue();
 
@@ -65,7 +228,590 @@ QoreValue QoreYamlParser::parse() {
     return rv.release();
 }
 
+QoreHashNode* QoreYamlParser::parseSelect(QoreYamlSelection& sel) {
+    if (!valid)
+        return nullptr;
+
+    if (getCheckEvent(YAML_STREAM_START_EVENT))
+        return nullptr;
+
+    if (getEvent())
+        return nullptr;
+
+    if (event.type == YAML_DOCUMENT_START_EVENT) {
+        if (getEvent())
+            return nullptr;
+
+        if (event.type != YAML_DOCUMENT_END_EVENT) {
+            yaml_select_state_t states;
+            for (size_t i = 0, e = sel.size(); i < e; ++i) {
+                states.emplace_back(i, 0);
+            }
+            selectNode(sel, states);
+            clearAnchors();
+            if (*xsink)
+                return nullptr;
+
+            if (getCheckEvent(YAML_DOCUMENT_END_EVENT))
+                return nullptr;
+        }
+
+        if (getEvent())
+            return nullptr;
+    }
+
+    if (checkEvent(YAML_STREAM_END_EVENT))
+        return nullptr;
+
+    return sel.takeResult();
+}
+
+// parses the current node if a path matches it; otherwise descends into containers that can contain matches and
+// skips all other nodes without creating values for them
+int QoreYamlParser::selectNode(QoreYamlSelection& sel, const yaml_select_state_t& states) {
+    if (states.empty())
+        return skipNode();
+
+    bool complete = false;
+    for (auto& i : states) {
+        if (i.pos == sel.getPath(i.i).size()) {
+            complete = true;
+            break;
+        }
+    }
+
+    // parse the entire node and match the remaining paths against the value
+    if (complete || event.type == YAML_ALIAS_EVENT) {
+        ValueHolder v(parseNode(), xsink);
+        if (*xsink)
+            return -1;
+        for (auto& i : states) {
+            sel.addFromValue(i.i, i.pos, *v, xsink);
+            if (*xsink)
+                return -1;
+        }
+        return 0;
+    }
+
+    if (event.type == YAML_SCALAR_EVENT) {
+        // a scalar cannot contain matches for paths with more segments
+        return skipNode();
+    }
+
+    // anchored containers are parsed so that later aliases can be resolved
+    if (getEventAnchor()) {
+        ValueHolder v(parseNode(), xsink);
+        if (*xsink)
+            return -1;
+        for (auto& i : states) {
+            sel.addFromValue(i.i, i.pos, *v, xsink);
+            if (*xsink)
+                return -1;
+        }
+        return 0;
+    }
+
+    yaml_select_state_t child_states;
+    if (event.type == YAML_SEQUENCE_START_EVENT) {
+        size_t index = 0;
+        while (true) {
+            if (getEvent())
+                return -1;
+
+            if (event.type == YAML_SEQUENCE_END_EVENT)
+                break;
+
+            child_states.clear();
+            for (auto& i : states) {
+                const QoreYamlPathSegment& seg = sel.getPath(i.i)[i.pos];
+                if (seg.type == QoreYamlPathSegment::ANY
+                    || (seg.type == QoreYamlPathSegment::INDEX && seg.index == index)) {
+                    child_states.emplace_back(i.i, i.pos + 1);
+                }
+            }
+            if (selectNode(sel, child_states))
+                return -1;
+            ++index;
+        }
+        return 0;
+    }
+
+    assert(event.type == YAML_MAPPING_START_EVENT);
+    while (true) {
+        if (getEvent())
+            return -1;
+
+        if (event.type == YAML_MAPPING_END_EVENT)
+            break;
+
+        std::string key;
+        if (event.type == YAML_SCALAR_EVENT && !event.data.scalar.tag && !event.data.scalar.anchor) {
+            key.assign((const char*)event.data.scalar.value, event.data.scalar.length);
+        } else {
+            ValueHolder k(parseNode(true), xsink);
+            if (*xsink)
+                return -1;
+            QoreStringValueHelper str(*k, QCS_UTF8, xsink);
+            if (*xsink)
+                return -1;
+            key.assign(str->c_str(), str->size());
+        }
+
+        child_states.clear();
+        for (auto& i : states) {
+            const QoreYamlPathSegment& seg = sel.getPath(i.i)[i.pos];
+            if (seg.type == QoreYamlPathSegment::ANY || (seg.type == QoreYamlPathSegment::KEY && seg.key == key)) {
+                child_states.emplace_back(i.i, i.pos + 1);
+            }
+        }
+
+        if (getEvent())
+            return -1;
+
+        if (selectNode(sel, child_states))
+            return -1;
+    }
+
+    return 0;
+}
+
+// skips the current node by counting the container depth
+int QoreYamlParser::skipNode() {
+    // anchored nodes are parsed so that later aliases can be resolved
+    if (getEventAnchor()) {
+        ValueHolder v(parseNode(), xsink);
+        return *xsink ? -1 : 0;
+    }
+
+    if (event.type != YAML_SEQUENCE_START_EVENT && event.type != YAML_MAPPING_START_EVENT)
+        return 0;
+
+    unsigned depth = 1;
+    while (depth) {
+        if (getEvent())
+            return -1;
+
+        switch (event.type) {
+            case YAML_SEQUENCE_START_EVENT:
+            case YAML_MAPPING_START_EVENT:
+                if (getEventAnchor()) {
+                    ValueHolder v(parseNode(), xsink);
+                    if (*xsink)
+                        return -1;
+                } else {
+                    ++depth;
+                }
+                break;
+
+            case YAML_SEQUENCE_END_EVENT:
+            case YAML_MAPPING_END_EVENT:
+                --depth;
+                break;
+
+            case YAML_SCALAR_EVENT:
+                if (getEventAnchor()) {
+                    ValueHolder v(parseNode(), xsink);
+                    if (*xsink)
+                        return -1;
+                }
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    return 0;
+}
+
+int QoreYamlSelection::init(const QoreListNode& l, ExceptionSink* xsink) {
+    ConstListIterator li(l);
+    int index = 0;
+    while (li.next()) {
+        const QoreValue v = li.getValue();
+        if (v.getType() != NT_STRING) {
+            xsink->raiseException("YAML-PATH-ERROR", "path expression %d is type '%s'; expecting 'string'", index,
+                v.getTypeName());
+            return -1;
+        }
+        ++index;
+
+        TempEncodingHelper str(*v.get<const QoreStringNode>(), QCS_UTF8, xsink);
+        if (*xsink)
+            return -1;
+
+        // ignore duplicate paths
+        if (rv->existsKey(str->c_str()))
+            continue;
+
+        paths.emplace_back();
+        QoreYamlPathInfo& info = paths.back();
+        info.name.assign(str->c_str(), str->size());
+
+        bool wildcard = false;
+        const char* p = str->c_str();
+        while (*p) {
+            QoreYamlPathSegment seg;
+            if (*p == '[') {
+                ++p;
+                if (*p == '*') {
+                    seg.type = QoreYamlPathSegment::ANY;
+                    ++p;
+                } else if (isdigit(*p)) {
+                    seg.type = QoreYamlPathSegment::INDEX;
+                    while (isdigit(*p)) {
+                        seg.index = seg.index * 10 + (*p - '0');
+                        ++p;
+                    }
+                } else {
+                    xsink->raiseException("YAML-PATH-ERROR", "invalid index in path expression '%s'; expecting a "
+                        "non-negative integer or '*'", str->c_str());
+                    return -1;
+                }
+                if (*p != ']') {
+                    xsink->raiseException("YAML-PATH-ERROR", "missing ']' in path expression '%s'", str->c_str());
+                    return -1;
+                }
+                ++p;
+            } else {
+                const char* start = p;
+                while (*p && *p != '.' && *p != '[') {
+                    ++p;
+                }
+                if (p == start) {
+                    xsink->raiseException("YAML-PATH-ERROR", "empty key in path expression '%s'", str->c_str());
+                    return -1;
+                }
+                if (p - start == 1 && *start == '*') {
+                    seg.type = QoreYamlPathSegment::ANY;
+                } else {
+                    seg.type = QoreYamlPathSegment::KEY;
+                    seg.key.assign(start, p - start);
+                }
+            }
+            if (seg.type == QoreYamlPathSegment::ANY) {
+                wildcard = true;
+            }
+            info.path.push_back(seg);
+
+            if (*p == '.') {
+                ++p;
+                if (!*p) {
+                    xsink->raiseException("YAML-PATH-ERROR", "empty key in path expression '%s'", str->c_str());
+                    return -1;
+                }
+            } else if (*p && *p != '[') {
+                xsink->raiseException("YAML-PATH-ERROR", "unexpected character '%c' after index in path "
+                    "expression '%s'", *p, str->c_str());
+                return -1;
+            }
+        }
+
+        if (wildcard) {
+            info.list = new QoreListNode(autoTypeInfo);
+            rv->setKeyValue(info.name.c_str(), info.list, xsink);
+        } else {
+            rv->setKeyValue(info.name.c_str(), QoreValue(), xsink);
+        }
+        if (*xsink)
+            return -1;
+    }
+
+    return 0;
+}
+
+void QoreYamlSelection::add(size_t i, QoreValue v, ExceptionSink* xsink) {
+    QoreYamlPathInfo& info = paths[i];
+    if (info.list) {
+        info.list->push(v, xsink);
+    } else {
+        rv->setKeyValue(info.name.c_str(), v, xsink);
+    }
+}
+
+void QoreYamlSelection::addFromValue(size_t i, size_t pos, const QoreValue& v, ExceptionSink* xsink) {
+    const yaml_path_t& path = paths[i].path;
+    if (pos == path.size()) {
+        add(i, v.refSelf(), xsink);
+        return;
+    }
+
+    const QoreYamlPathSegment& seg = path[pos];
+    switch (v.getType()) {
+        case NT_HASH: {
+            const QoreHashNode* h = v.get<const QoreHashNode>();
+            if (seg.type == QoreYamlPathSegment::KEY) {
+                if (h->existsKey(seg.key.c_str())) {
+                    addFromValue(i, pos + 1, h->getKeyValue(seg.key.c_str()), xsink);
+                }
+            } else if (seg.type == QoreYamlPathSegment::ANY) {
+                ConstHashIterator hi(*h);
+                while (hi.next() && !*xsink) {
+                    addFromValue(i, pos + 1, hi.get(), xsink);
+                }
+            }
+            break;
+        }
+
+        case NT_LIST: {
+            const QoreListNode* l = v.get<const QoreListNode>();
+            if (seg.type == QoreYamlPathSegment::INDEX) {
+                if (seg.index < l->size()) {
+                    addFromValue(i, pos + 1, l->retrieveEntry(seg.index), xsink);
+                }
+            } else if (seg.type == QoreYamlPathSegment::ANY) {
+                ConstListIterator li(*l);
+                while (li.next() && !*xsink) {
+                    addFromValue(i, pos + 1, li.getValue(), xsink);
+                }
+            }
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+static QoreHashNode* yaml_mark_hash(const yaml_mark_t& mark) {
+    QoreHashNode* h = new QoreHashNode(autoTypeInfo);
+    h->setKeyValue("line", (int64)mark.line, nullptr);
+    h->setKeyValue("column", (int64)mark.column, nullptr);
+    h->setKeyValue("index", (int64)mark.index, nullptr);
+    return h;
+}
+
+QoreHashNode* QoreYamlParser::parseEvent() {
+    if (!valid || stream_end)
+        return nullptr;
+
+    if (getEvent())
+        return nullptr;
+
+    ReferenceHolder<QoreHashNode> h(new QoreHashNode(autoTypeInfo), xsink);
+    h->setKeyValue("type", new QoreStringNode(get_event_name(event.type)), xsink);
+
+    const yaml_char_t* tag = nullptr;
+    const yaml_char_t* anchor = nullptr;
+    switch (event.type) {
+        case YAML_STREAM_END_EVENT:
+            stream_end = true;
+            break;
+
+        case YAML_SCALAR_EVENT: {
+            tag = event.data.scalar.tag;
+            anchor = event.data.scalar.anchor;
+            bool is_key = !event_ctx.empty() && event_ctx.back() == QYEC_MAP_KEY;
+            QoreValue v = parseScalar(is_key);
+            if (*xsink) {
+                valid = false;
+                return nullptr;
+            }
+            h->setKeyValue("value", v, xsink);
+            eventNodeDone();
+            break;
+        }
+
+        case YAML_ALIAS_EVENT:
+            anchor = event.data.alias.anchor;
+            eventNodeDone();
+            break;
+
+        case YAML_SEQUENCE_START_EVENT:
+            tag = event.data.sequence_start.tag;
+            anchor = event.data.sequence_start.anchor;
+            event_ctx.push_back(QYEC_SEQ);
+            break;
+
+        case YAML_MAPPING_START_EVENT:
+            tag = event.data.mapping_start.tag;
+            anchor = event.data.mapping_start.anchor;
+            event_ctx.push_back(QYEC_MAP_KEY);
+            break;
+
+        case YAML_SEQUENCE_END_EVENT:
+        case YAML_MAPPING_END_EVENT:
+            if (!event_ctx.empty()) {
+                event_ctx.pop_back();
+            }
+            eventNodeDone();
+            break;
+
+        default:
+            break;
+    }
+
+    if (tag) {
+        h->setKeyValue("tag", new QoreStringNode((const char*)tag, QCS_UTF8), xsink);
+    }
+    if (anchor) {
+        h->setKeyValue("anchor", new QoreStringNode((const char*)anchor, QCS_UTF8), xsink);
+    }
+    h->setKeyValue("start", yaml_mark_hash(event.start_mark), xsink);
+    h->setKeyValue("end", yaml_mark_hash(event.end_mark), xsink);
+
+    return h.release();
+}
+
+bool QoreYamlParser::parseNextDocument(QoreValue& val) {
+    if (!valid || stream_end)
+        return false;
+
+    if (!stream_start) {
+        if (getCheckEvent(YAML_STREAM_START_EVENT))
+            return false;
+        stream_start = true;
+    }
+
+    if (getEvent())
+        return false;
+
+    if (event.type == YAML_STREAM_END_EVENT) {
+        stream_end = true;
+        return false;
+    }
+
+    if (checkEvent(YAML_DOCUMENT_START_EVENT))
+        return false;
+
+    if (getEvent())
+        return false;
+
+    ValueHolder rv(xsink);
+    if (event.type != YAML_DOCUMENT_END_EVENT) {
+        rv = type_tmpl.isNothing() ? parseNode() : parseTypedNode(nullptr, type_tmpl);
+        if (!keep_anchors)
+            clearAnchors();
+        if (*xsink) {
+            valid = false;
+            return false;
+        }
+
+        if (getCheckEvent(YAML_DOCUMENT_END_EVENT))
+            return false;
+    }
+
+    val = rv.release();
+    return true;
+}
+
+int QoreYamlParser::checkLimits() {
+    size_t size;
+    switch (event.type) {
+        case YAML_DOCUMENT_START_EVENT:
+            total_bytes = total_nodes = depth = 0;
+            return 0;
+
+        case YAML_SCALAR_EVENT:
+            if (limits.max_scalar_len && event.data.scalar.length > limits.max_scalar_len) {
+                limit_exceeded = true;
+                valid = false;
+                xsink->raiseException(QY_PARSE_ERR, "scalar length " QLLD " at line %d exceeds the "
+                    "'max_scalar_len' limit of " QLLD, (int64)event.data.scalar.length, (int)event.start_mark.line + 1,
+                    (int64)limits.max_scalar_len);
+                return -1;
+            }
+            size = YAML_NODE_SIZE + event.data.scalar.length;
+            break;
+
+        case YAML_SEQUENCE_START_EVENT:
+        case YAML_MAPPING_START_EVENT:
+            if (limits.max_depth && ++depth > limits.max_depth) {
+                limit_exceeded = true;
+                valid = false;
+                xsink->raiseException(QY_PARSE_ERR, "nesting depth at line %d exceeds the 'max_depth' limit of "
+                    QLLD, (int)event.start_mark.line + 1, (int64)limits.max_depth);
+                return -1;
+            }
+            size = YAML_NODE_SIZE;
+            break;
+
+        case YAML_SEQUENCE_END_EVENT:
+        case YAML_MAPPING_END_EVENT:
+            if (depth) {
+                --depth;
+            }
+            return 0;
+
+        case YAML_ALIAS_EVENT:
+            // aliases reference the anchored value
+            size = 0;
+            break;
+
+        default:
+            return 0;
+    }
+
+    if (limits.max_nodes && ++total_nodes > limits.max_nodes) {
+        limit_exceeded = true;
+        valid = false;
+        xsink->raiseException(QY_PARSE_ERR, "the number of nodes in the document exceeds the 'max_nodes' limit of "
+            QLLD " at line %d", (int64)limits.max_nodes, (int)event.start_mark.line + 1);
+        return -1;
+    }
+    total_bytes += size;
+    if (limits.max_bytes && total_bytes > limits.max_bytes) {
+        limit_exceeded = true;
+        valid = false;
+        xsink->raiseException(QY_PARSE_ERR, "the memory required for the document exceeds the 'max_bytes' limit of "
+            QLLD " bytes at line %d", (int64)limits.max_bytes, (int)event.start_mark.line + 1);
+        return -1;
+    }
+    return 0;
+}
+
+const yaml_char_t* QoreYamlParser::getEventAnchor() const {
+    switch (event.type) {
+        case YAML_SCALAR_EVENT:
+            return event.data.scalar.anchor;
+
+        case YAML_SEQUENCE_START_EVENT:
+            return event.data.sequence_start.anchor;
+
+        case YAML_MAPPING_START_EVENT:
+            return event.data.mapping_start.anchor;
+
+        default:
+            break;
+    }
+
+    return nullptr;
+}
+
 QoreValue QoreYamlParser::parseNode(bool favor_string) {
+    switch (event.type) {
+        case YAML_SCALAR_EVENT:
+        case YAML_SEQUENCE_START_EVENT:
+        case YAML_MAPPING_START_EVENT:
+            break;
+
+        case YAML_ALIAS_EVENT:
+            return parseAlias();
+
+        default:
+            xsink->raiseException(QY_PARSE_ERR, "unexpected event '%s' when parsing YAML document",
+                get_event_name(event.type));
+            return QoreValue();
+    }
+
+    const yaml_char_t* anchor = getEventAnchor();
+    if (!anchor)
+        return parseNodeIntern(favor_string);
+
+    // the event is freed when the contents of a container are parsed
+    std::string name((const char*)anchor);
+    QoreValue rv = parseNodeIntern(favor_string);
+    if (*xsink)
+        return QoreValue();
+
+    // a later anchor with the same name replaces the earlier one
+    QoreValue& v = anchors[name];
+    v.discard(xsink);
+    v = rv.refSelf();
+    return rv;
+}
+
+QoreValue QoreYamlParser::parseNodeIntern(bool favor_string) {
     switch (event.type) {
         case YAML_SCALAR_EVENT:
             return parseScalar(favor_string);
@@ -77,13 +823,23 @@ QoreValue QoreYamlParser::parseNode(bool favor_string) {
             return parseMap();
 
         default:
-            xsink->raiseException(QY_PARSE_ERR, "unexpected event '%s' when parsing YAML document",
-                get_event_name(event.type));
+            assert(false);
     }
 
     return QoreValue();
 }
 
+// returns a new reference to the value already parsed for the anchor
+QoreValue QoreYamlParser::parseAlias() {
+    const char* name = (const char*)event.data.alias.anchor;
+    anchor_value_map_t::iterator i = anchors.find(name);
+    if (i == anchors.end()) {
+        xsink->raiseException(QY_PARSE_ERR, "alias '*%s' does not refer to a previously-defined anchor", name);
+        return QoreValue();
+    }
+    return i->second.refSelf();
+}
+
 QoreListNode* QoreYamlParser::parseSeq() {
     ReferenceHolder<QoreListNode> l(new QoreListNode(autoTypeInfo), xsink);
 
@@ -105,6 +861,8 @@ QoreListNode* QoreYamlParser::parseSeq() {
 
 QoreHashNode* QoreYamlParser::parseMap() {
     ReferenceHolder<QoreHashNode> h(new QoreHashNode(autoTypeInfo), xsink);
+    // storage for keys, reused for all keys in the mapping
+    std::string tmp;
 
     while (true) {
         if (getEvent())
@@ -113,6 +871,26 @@ QoreHashNode* QoreYamlParser::parseMap() {
         if (event.type == YAML_MAPPING_END_EVENT)
             break;
 
+        // untagged scalar keys are taken from the event without creating an intermediate value
+        if (event.type == YAML_SCALAR_EVENT && !event.data.scalar.tag && !event.data.scalar.anchor) {
+            const char* key = getKey((const char*)event.data.scalar.value, event.data.scalar.length, tmp);
+            if (!key)
+                return nullptr;
+
+            // get value
+            if (getEvent())
+                return nullptr;
+
+            QoreValue value = parseNode();
+            if (*xsink)
+                return nullptr;
+
+            h->setKeyValue(key, value, xsink);
+            if (*xsink)
+                return nullptr;
+            continue;
+        }
+
         // get key node and convert to string
         ValueHolder key(parseNode(true), xsink);
         if (*xsink)
@@ -141,6 +919,33 @@ QoreHashNode* QoreYamlParser::parseMap() {
     return h.release();
 }
 
+// the key must be copied, because the event is freed when the value is parsed; keys are copied to tmp if the default
+// encoding is UTF-8, otherwise repeated keys are reused from the cache, and keys are stored in tmp once the cache is
+// full
+const char* QoreYamlParser::getKey(const char* val, size_t len, std::string& tmp) {
+    if (QCS_DEFAULT == QCS_UTF8) {
+        tmp.assign(val, len);
+        return tmp.c_str();
+    }
+
+    key_cache_t::const_iterator i = key_cache.find(qore_yaml_key_ref{val, len});
+    if (i != key_cache.end())
+        return i->second.c_str();
+
+    QoreString str(val, len, QCS_UTF8);
+    TempEncodingHelper key(str, QCS_DEFAULT, xsink);
+    if (*xsink)
+        return nullptr;
+    tmp.assign(key->c_str(), key->size());
+
+    if (key_cache.size() >= YAML_MAX_KEY_CACHE)
+        return tmp.c_str();
+
+    key_store.emplace_back(val, len);
+    const std::string& k = key_store.back();
+    return key_cache.insert(key_cache_t::value_type(qore_yaml_key_ref{k.data(), len}, tmp)).first->second.c_str();
+}
+
 static DateTimeNode* dt_err(ExceptionSink* xsink, const char* val, const char* msg) {
     xsink->raiseException(QY_PARSE_ERR, "cannot parse timestamp value '%s': %s", val, msg);
     return nullptr;
@@ -216,6 +1021,509 @@ static QoreNumberNode* parseNumber(const char* val, size_t len) {
     return new QoreNumberNode(val);
 }
 
+// creates a number from the text of a decimal value with an optional fraction and exponent, or a value in the
+// format written for the !number tag; returns nullptr if the text is not a valid number
+static QoreNumberNode* yaml_make_number(const char* val, size_t len) {
+    const char* p = val;
+    const char* end = val + len;
+    if (p < end && (*p == '-' || *p == '+'))
+        ++p;
+
+    // @inf@ and @nan@ are exact as floating-point values
+    if ((end - p) == 5 && (!strncasecmp(p, "@nan@", 5) || !strncasecmp(p, "@inf@", 5)))
+        return new QoreNumberNode(parseFloat(val, len));
+    if ((end - p) > 5 && (p[5] == 'n') && (!strncasecmp(p, "@nan@", 5) || !strncasecmp(p, "@inf@", 5)))
+        return parseNumber(val, len);
+
+    const char* start = p;
+    while (p < end && isdigit(*p))
+        ++p;
+    if (p < end && *p == '.')
+        ++p;
+    while (p < end && isdigit(*p))
+        ++p;
+    // at least one digit is required
+    if (p == start || (p == start + 1 && *start == '.'))
+        return nullptr;
+
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        ++p;
+        if (p < end && (*p == '-' || *p == '+'))
+            ++p;
+        const char* exp = p;
+        while (p < end && isdigit(*p))
+            ++p;
+        if (p == exp)
+            return nullptr;
+    }
+
+    if (p == end)
+        return new QoreNumberNode(val);
+
+    // a trailing 'n' with an optional precision as written for the !number tag
+    if (*p != 'n' || (++p < end && !is_prec(p, end - p)))
+        return nullptr;
+    return parseNumber(val, len);
+}
+
+#if FLT_EVAL_METHOD == 0
+// powers of ten that are exactly representable as doubles
+static const double yaml_exact_pow10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19,
+    1e20, 1e21, 1e22,
+};
+#endif
+
+// converts mant * 10^exp10 with a single correctly-rounded floating-point operation if the mantissa and the power
+// of ten are both exact (Clinger's fast path); returns false if the value must be converted by yaml_eisel_lemire()
+// or q_strtod()
+static bool yaml_fast_float(uint64_t mant, int exp10, bool neg, double& d) {
+#if FLT_EVAL_METHOD == 0
+    if (mant > (1ULL << 53)) {
+        return false;
+    }
+    double v = (double)mant;
+    if (exp10 < 0) {
+        if (exp10 < -22) {
+            return false;
+        }
+        v /= yaml_exact_pow10[-exp10];
+    } else if (exp10 <= 22) {
+        v *= yaml_exact_pow10[exp10];
+    } else {
+        // ex: 12e30 = 12000000000e22 as long as the larger mantissa is still exact
+        if (exp10 > 22 + 15) {
+            return false;
+        }
+        v *= yaml_exact_pow10[exp10 - 22];
+        if (v > 9007199254740992.0) {
+            return false;
+        }
+        v *= yaml_exact_pow10[22];
+    }
+    d = neg ? -v : v;
+    return true;
+#else
+    return false;
+#endif
+}
+
+// 128-bit approximations of the powers of five from 5^-342 to 5^308, normalized so that the most significant bit is
+// set; each power is stored as the high and low 64 bits
+static const uint64_t yaml_pow5_128[] = {
+    0xeef453d6923bd65aULL, 0x113faa2906a13b3fULL, 0x9558b4661b6565f8ULL, 0x4ac7ca59a424c507ULL,
+    0xbaaee17fa23ebf76ULL, 0x5d79bcf00d2df649ULL, 0xe95a99df8ace6f53ULL, 0xf4d82c2c107973dcULL,
+    0x91d8a02bb6c10594ULL, 0x79071b9b8a4be869ULL, 0xb64ec836a47146f9ULL, 0x9748e2826cdee284ULL,
+    0xe3e27a444d8d98b7ULL, 0xfd1b1b2308169b25ULL, 0x8e6d8c6ab0787f72ULL, 0xfe30f0f5e50e20f7ULL,
+    0xb208ef855c969f4fULL, 0xbdbd2d335e51a935ULL, 0xde8b2b66b3bc4723ULL, 0xad2c788035e61382ULL,
+    0x8b16fb203055ac76ULL, 0x4c3bcb5021afcc31ULL, 0xaddcb9e83c6b1793ULL, 0xdf4abe242a1bbf3dULL,
+    0xd953e8624b85dd78ULL, 0xd71d6dad34a2af0dULL, 0x87d4713d6f33aa6bULL, 0x8672648c40e5ad68ULL,
+    0xa9c98d8ccb009506ULL, 0x680efdaf511f18c2ULL, 0xd43bf0effdc0ba48ULL, 0x0212bd1b2566def2ULL,
+    0x84a57695fe98746dULL, 0x014bb630f7604b57ULL, 0xa5ced43b7e3e9188ULL, 0x419ea3bd35385e2dULL,
+    0xcf42894a5dce35eaULL, 0x52064cac828675b9ULL, 0x818995ce7aa0e1b2ULL, 0x7343efebd1940993ULL,
+    0xa1ebfb4219491a1fULL, 0x1014ebe6c5f90bf8ULL, 0xca66fa129f9b60a6ULL, 0xd41a26e077774ef6ULL,
+    0xfd00b897478238d0ULL, 0x8920b098955522b4ULL, 0x9e20735e8cb16382ULL, 0x55b46e5f5d5535b0ULL,
+    0xc5a890362fddbc62ULL, 0xeb2189f734aa831dULL, 0xf712b443bbd52b7bULL, 0xa5e9ec7501d523e4ULL,
+    0x9a6bb0aa55653b2dULL, 0x47b233c92125366eULL, 0xc1069cd4eabe89f8ULL, 0x999ec0bb696e840aULL,
+    0xf148440a256e2c76ULL, 0xc00670ea43ca250dULL, 0x96cd2a865764dbcaULL, 0x380406926a5e5728ULL,
+    0xbc807527ed3e12bcULL, 0xc605083704f5ecf2ULL, 0xeba09271e88d976bULL, 0xf7864a44c633682eULL,
+    0x93445b8731587ea3ULL, 0x7ab3ee6afbe0211dULL, 0xb8157268fdae9e4cULL, 0x5960ea05bad82964ULL,
+    0xe61acf033d1a45dfULL, 0x6fb92487298e33bdULL, 0x8fd0c16206306babULL, 0xa5d3b6d479f8e056ULL,
+    0xb3c4f1ba87bc8696ULL, 0x8f48a4899877186cULL, 0xe0b62e2929aba83cULL, 0x331acdabfe94de87ULL,
+    0x8c71dcd9ba0b4925ULL, 0x9ff0c08b7f1d0b14ULL, 0xaf8e5410288e1b6fULL, 0x07ecf0ae5ee44dd9ULL,
+    0xdb71e91432b1a24aULL, 0xc9e82cd9f69d6150ULL, 0x892731ac9faf056eULL, 0xbe311c083a225cd2ULL,
+    0xab70fe17c79ac6caULL, 0x6dbd630a48aaf406ULL, 0xd64d3d9db981787dULL, 0x092cbbccdad5b108ULL,
+    0x85f0468293f0eb4eULL, 0x25bbf56008c58ea5ULL, 0xa76c582338ed2621ULL, 0xaf2af2b80af6f24eULL,
+    0xd1476e2c07286faaULL, 0x1af5af660db4aee1ULL, 0x82cca4db847945caULL, 0x50d98d9fc890ed4dULL,
+    0xa37fce126597973cULL, 0xe50ff107bab528a0ULL, 0xcc5fc196fefd7d0cULL, 0x1e53ed49a96272c8ULL,
+    0xff77b1fcbebcdc4fULL, 0x25e8e89c13bb0f7aULL, 0x9faacf3df73609b1ULL, 0x77b191618c54e9acULL,
+    0xc795830d75038c1dULL, 0xd59df5b9ef6a2417ULL, 0xf97ae3d0d2446f25ULL, 0x4b0573286b44ad1dULL,
+    0x9becce62836ac577ULL, 0x4ee367f9430aec32ULL, 0xc2e801fb244576d5ULL, 0x229c41f793cda73fULL,
+    0xf3a20279ed56d48aULL, 0x6b43527578c1110fULL, 0x9845418c345644d6ULL, 0x830a13896b78aaa9ULL,
+    0xbe5691ef416bd60cULL, 0x23cc986bc656d553ULL, 0xedec366b11c6cb8fULL, 0x2cbfbe86b7ec8aa8ULL,
+    0x94b3a202eb1c3f39ULL, 0x7bf7d71432f3d6a9ULL, 0xb9e08a83a5e34f07ULL, 0xdaf5ccd93fb0cc53ULL,
+    0xe858ad248f5c22c9ULL, 0xd1b3400f8f9cff68ULL, 0x91376c36d99995beULL, 0x23100809b9c21fa1ULL,
+    0xb58547448ffffb2dULL, 0xabd40a0c2832a78aULL, 0xe2e69915b3fff9f9ULL, 0x16c90c8f323f516cULL,
+    0x8dd01fad907ffc3bULL, 0xae3da7d97f6792e3ULL, 0xb1442798f49ffb4aULL, 0x99cd11cfdf41779cULL,
+    0xdd95317f31c7fa1dULL, 0x40405643d711d583ULL, 0x8a7d3eef7f1cfc52ULL, 0x482835ea666b2572ULL,
+    0xad1c8eab5ee43b66ULL, 0xda3243650005eecfULL, 0xd863b256369d4a40ULL, 0x90bed43e40076a82ULL,
+    0x873e4f75e2224e68ULL, 0x5a7744a6e804a291ULL, 0xa90de3535aaae202ULL, 0x711515d0a205cb36ULL,
+    0xd3515c2831559a83ULL, 0x0d5a5b44ca873e03ULL, 0x8412d9991ed58091ULL, 0xe858790afe9486c2ULL,
+    0xa5178fff668ae0b6ULL, 0x626e974dbe39a872ULL, 0xce5d73ff402d98e3ULL, 0xfb0a3d212dc8128fULL,
+    0x80fa687f881c7f8eULL, 0x7ce66634bc9d0b99ULL, 0xa139029f6a239f72ULL, 0x1c1fffc1ebc44e80ULL,
+    0xc987434744ac874eULL, 0xa327ffb266b56220ULL, 0xfbe9141915d7a922ULL, 0x4bf1ff9f0062baa8ULL,
+    0x9d71ac8fada6c9b5ULL, 0x6f773fc3603db4a9ULL, 0xc4ce17b399107c22ULL, 0xcb550fb4384d21d3ULL,
+    0xf6019da07f549b2bULL, 0x7e2a53a146606a48ULL, 0x99c102844f94e0fbULL, 0x2eda7444cbfc426dULL,
+    0xc0314325637a1939ULL, 0xfa911155fefb5308ULL, 0xf03d93eebc589f88ULL, 0x793555ab7eba27caULL,
+    0x96267c7535b763b5ULL, 0x4bc1558b2f3458deULL, 0xbbb01b9283253ca2ULL, 0x9eb1aaedfb016f16ULL,
+    0xea9c227723ee8bcbULL, 0x465e15a979c1cadcULL, 0x92a1958a7675175fULL, 0x0bfacd89ec191ec9ULL,
+    0xb749faed14125d36ULL, 0xcef980ec671f667bULL, 0xe51c79a85916f484ULL, 0x82b7e12780e7401aULL,
+    0x8f31cc0937ae58d2ULL, 0xd1b2ecb8b0908810ULL, 0xb2fe3f0b8599ef07ULL, 0x861fa7e6dcb4aa15ULL,
+    0xdfbdcece67006ac9ULL, 0x67a791e093e1d49aULL, 0x8bd6a141006042bdULL, 0xe0c8bb2c5c6d24e0ULL,
+    0xaecc49914078536dULL, 0x58fae9f773886e18ULL, 0xda7f5bf590966848ULL, 0xaf39a475506a899eULL,
+    0x888f99797a5e012dULL, 0x6d8406c952429603ULL, 0xaab37fd7d8f58178ULL, 0xc8e5087ba6d33b83ULL,
+    0xd5605fcdcf32e1d6ULL, 0xfb1e4a9a90880a64ULL, 0x855c3be0a17fcd26ULL, 0x5cf2eea09a55067fULL,
+    0xa6b34ad8c9dfc06fULL, 0xf42faa48c0ea481eULL, 0xd0601d8efc57b08bULL, 0xf13b94daf124da26ULL,
+    0x823c12795db6ce57ULL, 0x76c53d08d6b70858ULL, 0xa2cb1717b52481edULL, 0x54768c4b0c64ca6eULL,
+    0xcb7ddcdda26da268ULL, 0xa9942f5dcf7dfd09ULL, 0xfe5d54150b090b02ULL, 0xd3f93b35435d7c4cULL,
+    0x9efa548d26e5a6e1ULL, 0xc47bc5014a1a6dafULL, 0xc6b8e9b0709f109aULL, 0x359ab6419ca1091bULL,
+    0xf867241c8cc6d4c0ULL, 0xc30163d203c94b62ULL, 0x9b407691d7fc44f8ULL, 0x79e0de63425dcf1dULL,
+    0xc21094364dfb5636ULL, 0x985915fc12f542e4ULL, 0xf294b943e17a2bc4ULL, 0x3e6f5b7b17b2939dULL,
+    0x979cf3ca6cec5b5aULL, 0xa705992ceecf9c42ULL, 0xbd8430bd08277231ULL, 0x50c6ff782a838353ULL,
+    0xece53cec4a314ebdULL, 0xa4f8bf5635246428ULL, 0x940f4613ae5ed136ULL, 0x871b7795e136be99ULL,
+    0xb913179899f68584ULL, 0x28e2557b59846e3fULL, 0xe757dd7ec07426e5ULL, 0x331aeada2fe589cfULL,
+    0x9096ea6f3848984fULL, 0x3ff0d2c85def7621ULL, 0xb4bca50b065abe63ULL, 0x0fed077a756b53a9ULL,
+    0xe1ebce4dc7f16dfbULL, 0xd3e8495912c62894ULL, 0x8d3360f09cf6e4bdULL, 0x64712dd7abbbd95cULL,
+    0xb080392cc4349decULL, 0xbd8d794d96aacfb3ULL, 0xdca04777f541c567ULL, 0xecf0d7a0fc5583a0ULL,
+    0x89e42caaf9491b60ULL, 0xf41686c49db57244ULL, 0xac5d37d5b79b6239ULL, 0x311c2875c522ced5ULL,
+    0xd77485cb25823ac7ULL, 0x7d633293366b828bULL, 0x86a8d39ef77164bcULL, 0xae5dff9c02033197ULL,
+    0xa8530886b54dbdebULL, 0xd9f57f830283fdfcULL, 0xd267caa862a12d66ULL, 0xd072df63c324fd7bULL,
+    0x8380dea93da4bc60ULL, 0x4247cb9e59f71e6dULL, 0xa46116538d0deb78ULL, 0x52d9be85f074e608ULL,
+    0xcd795be870516656ULL, 0x67902e276c921f8bULL, 0x806bd9714632dff6ULL, 0x00ba1cd8a3db53b6ULL,
+    0xa086cfcd97bf97f3ULL, 0x80e8a40eccd228a4ULL, 0xc8a883c0fdaf7df0ULL, 0x6122cd128006b2cdULL,
+    0xfad2a4b13d1b5d6cULL, 0x796b805720085f81ULL, 0x9cc3a6eec6311a63ULL, 0xcbe3303674053bb0ULL,
+    0xc3f490aa77bd60fcULL, 0xbedbfc4411068a9cULL, 0xf4f1b4d515acb93bULL, 0xee92fb5515482d44ULL,
+    0x991711052d8bf3c5ULL, 0x751bdd152d4d1c4aULL, 0xbf5cd54678eef0b6ULL, 0xd262d45a78a0635dULL,
+    0xef340a98172aace4ULL, 0x86fb897116c87c34ULL, 0x9580869f0e7aac0eULL, 0xd45d35e6ae3d4da0ULL,
+    0xbae0a846d2195712ULL, 0x8974836059cca109ULL, 0xe998d258869facd7ULL, 0x2bd1a438703fc94bULL,
+    0x91ff83775423cc06ULL, 0x7b6306a34627ddcfULL, 0xb67f6455292cbf08ULL, 0x1a3bc84c17b1d542ULL,
+    0xe41f3d6a7377eecaULL, 0x20caba5f1d9e4a93ULL, 0x8e938662882af53eULL, 0x547eb47b7282ee9cULL,
+    0xb23867fb2a35b28dULL, 0xe99e619a4f23aa43ULL, 0xdec681f9f4c31f31ULL, 0x6405fa00e2ec94d4ULL,
+    0x8b3c113c38f9f37eULL, 0xde83bc408dd3dd04ULL, 0xae0b158b4738705eULL, 0x9624ab50b148d445ULL,
+    0xd98ddaee19068c76ULL, 0x3badd624dd9b0957ULL, 0x87f8a8d4cfa417c9ULL, 0xe54ca5d70a80e5d6ULL,
+    0xa9f6d30a038d1dbcULL, 0x5e9fcf4ccd211f4cULL, 0xd47487cc8470652bULL, 0x7647c3200069671fULL,
+    0x84c8d4dfd2c63f3bULL, 0x29ecd9f40041e073ULL, 0xa5fb0a17c777cf09ULL, 0xf468107100525890ULL,
+    0xcf79cc9db955c2ccULL, 0x7182148d4066eeb4ULL, 0x81ac1fe293d599bfULL, 0xc6f14cd848405530ULL,
+    0xa21727db38cb002fULL, 0xb8ada00e5a506a7cULL, 0xca9cf1d206fdc03bULL, 0xa6d90811f0e4851cULL,
+    0xfd442e4688bd304aULL, 0x908f4a166d1da663ULL, 0x9e4a9cec15763e2eULL, 0x9a598e4e043287feULL,
+    0xc5dd44271ad3cdbaULL, 0x40eff1e1853f29fdULL, 0xf7549530e188c128ULL, 0xd12bee59e68ef47cULL,
+    0x9a94dd3e8cf578b9ULL, 0x82bb74f8301958ceULL, 0xc13a148e3032d6e7ULL, 0xe36a52363c1faf01ULL,
+    0xf18899b1bc3f8ca1ULL, 0xdc44e6c3cb279ac1ULL, 0x96f5600f15a7b7e5ULL, 0x29ab103a5ef8c0b9ULL,
+    0xbcb2b812db11a5deULL, 0x7415d448f6b6f0e7ULL, 0xebdf661791d60f56ULL, 0x111b495b3464ad21ULL,
+    0x936b9fcebb25c995ULL, 0xcab10dd900beec34ULL, 0xb84687c269ef3bfbULL, 0x3d5d514f40eea742ULL,
+    0xe65829b3046b0afaULL, 0x0cb4a5a3112a5112ULL, 0x8ff71a0fe2c2e6dcULL, 0x47f0e785eaba72abULL,
+    0xb3f4e093db73a093ULL, 0x59ed216765690f56ULL, 0xe0f218b8d25088b8ULL, 0x306869c13ec3532cULL,
+    0x8c974f7383725573ULL, 0x1e414218c73a13fbULL, 0xafbd2350644eeacfULL, 0xe5d1929ef90898faULL,
+    0xdbac6c247d62a583ULL, 0xdf45f746b74abf39ULL, 0x894bc396ce5da772ULL, 0x6b8bba8c328eb783ULL,
+    0xab9eb47c81f5114fULL, 0x066ea92f3f326564ULL, 0xd686619ba27255a2ULL, 0xc80a537b0efefebdULL,
+    0x8613fd0145877585ULL, 0xbd06742ce95f5f36ULL, 0xa798fc4196e952e7ULL, 0x2c48113823b73704ULL,
+    0xd17f3b51fca3a7a0ULL, 0xf75a15862ca504c5ULL, 0x82ef85133de648c4ULL, 0x9a984d73dbe722fbULL,
+    0xa3ab66580d5fdaf5ULL, 0xc13e60d0d2e0ebbaULL, 0xcc963fee10b7d1b3ULL, 0x318df905079926a8ULL,
+    0xffbbcfe994e5c61fULL, 0xfdf17746497f7052ULL, 0x9fd561f1fd0f9bd3ULL, 0xfeb6ea8bedefa633ULL,
+    0xc7caba6e7c5382c8ULL, 0xfe64a52ee96b8fc0ULL, 0xf9bd690a1b68637bULL, 0x3dfdce7aa3c673b0ULL,
+    0x9c1661a651213e2dULL, 0x06bea10ca65c084eULL, 0xc31bfa0fe5698db8ULL, 0x486e494fcff30a62ULL,
+    0xf3e2f893dec3f126ULL, 0x5a89dba3c3efccfaULL, 0x986ddb5c6b3a76b7ULL, 0xf89629465a75e01cULL,
+    0xbe89523386091465ULL, 0xf6bbb397f1135823ULL, 0xee2ba6c0678b597fULL, 0x746aa07ded582e2cULL,
+    0x94db483840b717efULL, 0xa8c2a44eb4571cdcULL, 0xba121a4650e4ddebULL, 0x92f34d62616ce413ULL,
+    0xe896a0d7e51e1566ULL, 0x77b020baf9c81d17ULL, 0x915e2486ef32cd60ULL, 0x0ace1474dc1d122eULL,
+    0xb5b5ada8aaff80b8ULL, 0x0d819992132456baULL, 0xe3231912d5bf60e6ULL, 0x10e1fff697ed6c69ULL,
+    0x8df5efabc5979c8fULL, 0xca8d3ffa1ef463c1ULL, 0xb1736b96b6fd83b3ULL, 0xbd308ff8a6b17cb2ULL,
+    0xddd0467c64bce4a0ULL, 0xac7cb3f6d05ddbdeULL, 0x8aa22c0dbef60ee4ULL, 0x6bcdf07a423aa96bULL,
+    0xad4ab7112eb3929dULL, 0x86c16c98d2c953c6ULL, 0xd89d64d57a607744ULL, 0xe871c7bf077ba8b7ULL,
+    0x87625f056c7c4a8bULL, 0x11471cd764ad4972ULL, 0xa93af6c6c79b5d2dULL, 0xd598e40d3dd89bcfULL,
+    0xd389b47879823479ULL, 0x4aff1d108d4ec2c3ULL, 0x843610cb4bf160cbULL, 0xcedf722a585139baULL,
+    0xa54394fe1eedb8feULL, 0xc2974eb4ee658828ULL, 0xce947a3da6a9273eULL, 0x733d226229feea32ULL,
+    0x811ccc668829b887ULL, 0x0806357d5a3f525fULL, 0xa163ff802a3426a8ULL, 0xca07c2dcb0cf26f7ULL,
+    0xc9bcff6034c13052ULL, 0xfc89b393dd02f0b5ULL, 0xfc2c3f3841f17c67ULL, 0xbbac2078d443ace2ULL,
+    0x9d9ba7832936edc0ULL, 0xd54b944b84aa4c0dULL, 0xc5029163f384a931ULL, 0x0a9e795e65d4df11ULL,
+    0xf64335bcf065d37dULL, 0x4d4617b5ff4a16d5ULL, 0x99ea0196163fa42eULL, 0x504bced1bf8e4e45ULL,
+    0xc06481fb9bcf8d39ULL, 0xe45ec2862f71e1d6ULL, 0xf07da27a82c37088ULL, 0x5d767327bb4e5a4cULL,
+    0x964e858c91ba2655ULL, 0x3a6a07f8d510f86fULL, 0xbbe226efb628afeaULL, 0x890489f70a55368bULL,
+    0xeadab0aba3b2dbe5ULL, 0x2b45ac74ccea842eULL, 0x92c8ae6b464fc96fULL, 0x3b0b8bc90012929dULL,
+    0xb77ada0617e3bbcbULL, 0x09ce6ebb40173744ULL, 0xe55990879ddcaabdULL, 0xcc420a6a101d0515ULL,
+    0x8f57fa54c2a9eab6ULL, 0x9fa946824a12232dULL, 0xb32df8e9f3546564ULL, 0x47939822dc96abf9ULL,
+    0xdff9772470297ebdULL, 0x59787e2b93bc56f7ULL, 0x8bfbea76c619ef36ULL, 0x57eb4edb3c55b65aULL,
+    0xaefae51477a06b03ULL, 0xede622920b6b23f1ULL, 0xdab99e59958885c4ULL, 0xe95fab368e45ecedULL,
+    0x88b402f7fd75539bULL, 0x11dbcb0218ebb414ULL, 0xaae103b5fcd2a881ULL, 0xd652bdc29f26a119ULL,
+    0xd59944a37c0752a2ULL, 0x4be76d3346f0495fULL, 0x857fcae62d8493a5ULL, 0x6f70a4400c562ddbULL,
+    0xa6dfbd9fb8e5b88eULL, 0xcb4ccd500f6bb952ULL, 0xd097ad07a71f26b2ULL, 0x7e2000a41346a7a7ULL,
+    0x825ecc24c873782fULL, 0x8ed400668c0c28c8ULL, 0xa2f67f2dfa90563bULL, 0x728900802f0f32faULL,
+    0xcbb41ef979346bcaULL, 0x4f2b40a03ad2ffb9ULL, 0xfea126b7d78186bcULL, 0xe2f610c84987bfa8ULL,
+    0x9f24b832e6b0f436ULL, 0x0dd9ca7d2df4d7c9ULL, 0xc6ede63fa05d3143ULL, 0x91503d1c79720dbbULL,
+    0xf8a95fcf88747d94ULL, 0x75a44c6397ce912aULL, 0x9b69dbe1b548ce7cULL, 0xc986afbe3ee11abaULL,
+    0xc24452da229b021bULL, 0xfbe85badce996168ULL, 0xf2d56790ab41c2a2ULL, 0xfae27299423fb9c3ULL,
+    0x97c560ba6b0919a5ULL, 0xdccd879fc967d41aULL, 0xbdb6b8e905cb600fULL, 0x5400e987bbc1c920ULL,
+    0xed246723473e3813ULL, 0x290123e9aab23b68ULL, 0x9436c0760c86e30bULL, 0xf9a0b6720aaf6521ULL,
+    0xb94470938fa89bceULL, 0xf808e40e8d5b3e69ULL, 0xe7958cb87392c2c2ULL, 0xb60b1d1230b20e04ULL,
+    0x90bd77f3483bb9b9ULL, 0xb1c6f22b5e6f48c2ULL, 0xb4ecd5f01a4aa828ULL, 0x1e38aeb6360b1af3ULL,
+    0xe2280b6c20dd5232ULL, 0x25c6da63c38de1b0ULL, 0x8d590723948a535fULL, 0x579c487e5a38ad0eULL,
+    0xb0af48ec79ace837ULL, 0x2d835a9df0c6d851ULL, 0xdcdb1b2798182244ULL, 0xf8e431456cf88e65ULL,
+    0x8a08f0f8bf0f156bULL, 0x1b8e9ecb641b58ffULL, 0xac8b2d36eed2dac5ULL, 0xe272467e3d222f3fULL,
+    0xd7adf884aa879177ULL, 0x5b0ed81dcc6abb0fULL, 0x86ccbb52ea94baeaULL, 0x98e947129fc2b4e9ULL,
+    0xa87fea27a539e9a5ULL, 0x3f2398d747b36224ULL, 0xd29fe4b18e88640eULL, 0x8eec7f0d19a03aadULL,
+    0x83a3eeeef9153e89ULL, 0x1953cf68300424acULL, 0xa48ceaaab75a8e2bULL, 0x5fa8c3423c052dd7ULL,
+    0xcdb02555653131b6ULL, 0x3792f412cb06794dULL, 0x808e17555f3ebf11ULL, 0xe2bbd88bbee40bd0ULL,
+    0xa0b19d2ab70e6ed6ULL, 0x5b6aceaeae9d0ec4ULL, 0xc8de047564d20a8bULL, 0xf245825a5a445275ULL,
+    0xfb158592be068d2eULL, 0xeed6e2f0f0d56712ULL, 0x9ced737bb6c4183dULL, 0x55464dd69685606bULL,
+    0xc428d05aa4751e4cULL, 0xaa97e14c3c26b886ULL, 0xf53304714d9265dfULL, 0xd53dd99f4b3066a8ULL,
+    0x993fe2c6d07b7fabULL, 0xe546a8038efe4029ULL, 0xbf8fdb78849a5f96ULL, 0xde98520472bdd033ULL,
+    0xef73d256a5c0f77cULL, 0x963e66858f6d4440ULL, 0x95a8637627989aadULL, 0xdde7001379a44aa8ULL,
+    0xbb127c53b17ec159ULL, 0x5560c018580d5d52ULL, 0xe9d71b689dde71afULL, 0xaab8f01e6e10b4a6ULL,
+    0x9226712162ab070dULL, 0xcab3961304ca70e8ULL, 0xb6b00d69bb55c8d1ULL, 0x3d607b97c5fd0d22ULL,
+    0xe45c10c42a2b3b05ULL, 0x8cb89a7db77c506aULL, 0x8eb98a7a9a5b04e3ULL, 0x77f3608e92adb242ULL,
+    0xb267ed1940f1c61cULL, 0x55f038b237591ed3ULL, 0xdf01e85f912e37a3ULL, 0x6b6c46dec52f6688ULL,
+    0x8b61313bbabce2c6ULL, 0x2323ac4b3b3da015ULL, 0xae397d8aa96c1b77ULL, 0xabec975e0a0d081aULL,
+    0xd9c7dced53c72255ULL, 0x96e7bd358c904a21ULL, 0x881cea14545c7575ULL, 0x7e50d64177da2e54ULL,
+    0xaa242499697392d2ULL, 0xdde50bd1d5d0b9e9ULL, 0xd4ad2dbfc3d07787ULL, 0x955e4ec64b44e864ULL,
+    0x84ec3c97da624ab4ULL, 0xbd5af13bef0b113eULL, 0xa6274bbdd0fadd61ULL, 0xecb1ad8aeacdd58eULL,
+    0xcfb11ead453994baULL, 0x67de18eda5814af2ULL, 0x81ceb32c4b43fcf4ULL, 0x80eacf948770ced7ULL,
+    0xa2425ff75e14fc31ULL, 0xa1258379a94d028dULL, 0xcad2f7f5359a3b3eULL, 0x096ee45813a04330ULL,
+    0xfd87b5f28300ca0dULL, 0x8bca9d6e188853fcULL, 0x9e74d1b791e07e48ULL, 0x775ea264cf55347eULL,
+    0xc612062576589ddaULL, 0x95364afe032a819eULL, 0xf79687aed3eec551ULL, 0x3a83ddbd83f52205ULL,
+    0x9abe14cd44753b52ULL, 0xc4926a9672793543ULL, 0xc16d9a0095928a27ULL, 0x75b7053c0f178294ULL,
+    0xf1c90080baf72cb1ULL, 0x5324c68b12dd6339ULL, 0x971da05074da7beeULL, 0xd3f6fc16ebca5e04ULL,
+    0xbce5086492111aeaULL, 0x88f4bb1ca6bcf585ULL, 0xec1e4a7db69561a5ULL, 0x2b31e9e3d06c32e6ULL,
+    0x9392ee8e921d5d07ULL, 0x3aff322e62439fd0ULL, 0xb877aa3236a4b449ULL, 0x09befeb9fad487c3ULL,
+    0xe69594bec44de15bULL, 0x4c2ebe687989a9b4ULL, 0x901d7cf73ab0acd9ULL, 0x0f9d37014bf60a11ULL,
+    0xb424dc35095cd80fULL, 0x538484c19ef38c95ULL, 0xe12e13424bb40e13ULL, 0x2865a5f206b06fbaULL,
+    0x8cbccc096f5088cbULL, 0xf93f87b7442e45d4ULL, 0xafebff0bcb24aafeULL, 0xf78f69a51539d749ULL,
+    0xdbe6fecebdedd5beULL, 0xb573440e5a884d1cULL, 0x89705f4136b4a597ULL, 0x31680a88f8953031ULL,
+    0xabcc77118461cefcULL, 0xfdc20d2b36ba7c3eULL, 0xd6bf94d5e57a42bcULL, 0x3d32907604691b4dULL,
+    0x8637bd05af6c69b5ULL, 0xa63f9a49c2c1b110ULL, 0xa7c5ac471b478423ULL, 0x0fcf80dc33721d54ULL,
+    0xd1b71758e219652bULL, 0xd3c36113404ea4a9ULL, 0x83126e978d4fdf3bULL, 0x645a1cac083126eaULL,
+    0xa3d70a3d70a3d70aULL, 0x3d70a3d70a3d70a4ULL, 0xccccccccccccccccULL, 0xcccccccccccccccdULL,
+    0x8000000000000000ULL, 0x0000000000000000ULL, 0xa000000000000000ULL, 0x0000000000000000ULL,
+    0xc800000000000000ULL, 0x0000000000000000ULL, 0xfa00000000000000ULL, 0x0000000000000000ULL,
+    0x9c40000000000000ULL, 0x0000000000000000ULL, 0xc350000000000000ULL, 0x0000000000000000ULL,
+    0xf424000000000000ULL, 0x0000000000000000ULL, 0x9896800000000000ULL, 0x0000000000000000ULL,
+    0xbebc200000000000ULL, 0x0000000000000000ULL, 0xee6b280000000000ULL, 0x0000000000000000ULL,
+    0x9502f90000000000ULL, 0x0000000000000000ULL, 0xba43b74000000000ULL, 0x0000000000000000ULL,
+    0xe8d4a51000000000ULL, 0x0000000000000000ULL, 0x9184e72a00000000ULL, 0x0000000000000000ULL,
+    0xb5e620f480000000ULL, 0x0000000000000000ULL, 0xe35fa931a0000000ULL, 0x0000000000000000ULL,
+    0x8e1bc9bf04000000ULL, 0x0000000000000000ULL, 0xb1a2bc2ec5000000ULL, 0x0000000000000000ULL,
+    0xde0b6b3a76400000ULL, 0x0000000000000000ULL, 0x8ac7230489e80000ULL, 0x0000000000000000ULL,
+    0xad78ebc5ac620000ULL, 0x0000000000000000ULL, 0xd8d726b7177a8000ULL, 0x0000000000000000ULL,
+    0x878678326eac9000ULL, 0x0000000000000000ULL, 0xa968163f0a57b400ULL, 0x0000000000000000ULL,
+    0xd3c21bcecceda100ULL, 0x0000000000000000ULL, 0x84595161401484a0ULL, 0x0000000000000000ULL,
+    0xa56fa5b99019a5c8ULL, 0x0000000000000000ULL, 0xcecb8f27f4200f3aULL, 0x0000000000000000ULL,
+    0x813f3978f8940984ULL, 0x4000000000000000ULL, 0xa18f07d736b90be5ULL, 0x5000000000000000ULL,
+    0xc9f2c9cd04674edeULL, 0xa400000000000000ULL, 0xfc6f7c4045812296ULL, 0x4d00000000000000ULL,
+    0x9dc5ada82b70b59dULL, 0xf020000000000000ULL, 0xc5371912364ce305ULL, 0x6c28000000000000ULL,
+    0xf684df56c3e01bc6ULL, 0xc732000000000000ULL, 0x9a130b963a6c115cULL, 0x3c7f400000000000ULL,
+    0xc097ce7bc90715b3ULL, 0x4b9f100000000000ULL, 0xf0bdc21abb48db20ULL, 0x1e86d40000000000ULL,
+    0x96769950b50d88f4ULL, 0x1314448000000000ULL, 0xbc143fa4e250eb31ULL, 0x17d955a000000000ULL,
+    0xeb194f8e1ae525fdULL, 0x5dcfab0800000000ULL, 0x92efd1b8d0cf37beULL, 0x5aa1cae500000000ULL,
+    0xb7abc627050305adULL, 0xf14a3d9e40000000ULL, 0xe596b7b0c643c719ULL, 0x6d9ccd05d0000000ULL,
+    0x8f7e32ce7bea5c6fULL, 0xe4820023a2000000ULL, 0xb35dbf821ae4f38bULL, 0xdda2802c8a800000ULL,
+    0xe0352f62a19e306eULL, 0xd50b2037ad200000ULL, 0x8c213d9da502de45ULL, 0x4526f422cc340000ULL,
+    0xaf298d050e4395d6ULL, 0x9670b12b7f410000ULL, 0xdaf3f04651d47b4cULL, 0x3c0cdd765f114000ULL,
+    0x88d8762bf324cd0fULL, 0xa5880a69fb6ac800ULL, 0xab0e93b6efee0053ULL, 0x8eea0d047a457a00ULL,
+    0xd5d238a4abe98068ULL, 0x72a4904598d6d880ULL, 0x85a36366eb71f041ULL, 0x47a6da2b7f864750ULL,
+    0xa70c3c40a64e6c51ULL, 0x999090b65f67d924ULL, 0xd0cf4b50cfe20765ULL, 0xfff4b4e3f741cf6dULL,
+    0x82818f1281ed449fULL, 0xbff8f10e7a8921a4ULL, 0xa321f2d7226895c7ULL, 0xaff72d52192b6a0dULL,
+    0xcbea6f8ceb02bb39ULL, 0x9bf4f8a69f764490ULL, 0xfee50b7025c36a08ULL, 0x02f236d04753d5b4ULL,
+    0x9f4f2726179a2245ULL, 0x01d762422c946590ULL, 0xc722f0ef9d80aad6ULL, 0x424d3ad2b7b97ef5ULL,
+    0xf8ebad2b84e0d58bULL, 0xd2e0898765a7deb2ULL, 0x9b934c3b330c8577ULL, 0x63cc55f49f88eb2fULL,
+    0xc2781f49ffcfa6d5ULL, 0x3cbf6b71c76b25fbULL, 0xf316271c7fc3908aULL, 0x8bef464e3945ef7aULL,
+    0x97edd871cfda3a56ULL, 0x97758bf0e3cbb5acULL, 0xbde94e8e43d0c8ecULL, 0x3d52eeed1cbea317ULL,
+    0xed63a231d4c4fb27ULL, 0x4ca7aaa863ee4bddULL, 0x945e455f24fb1cf8ULL, 0x8fe8caa93e74ef6aULL,
+    0xb975d6b6ee39e436ULL, 0xb3e2fd538e122b44ULL, 0xe7d34c64a9c85d44ULL, 0x60dbbca87196b616ULL,
+    0x90e40fbeea1d3a4aULL, 0xbc8955e946fe31cdULL, 0xb51d13aea4a488ddULL, 0x6babab6398bdbe41ULL,
+    0xe264589a4dcdab14ULL, 0xc696963c7eed2dd1ULL, 0x8d7eb76070a08aecULL, 0xfc1e1de5cf543ca2ULL,
+    0xb0de65388cc8ada8ULL, 0x3b25a55f43294bcbULL, 0xdd15fe86affad912ULL, 0x49ef0eb713f39ebeULL,
+    0x8a2dbf142dfcc7abULL, 0x6e3569326c784337ULL, 0xacb92ed9397bf996ULL, 0x49c2c37f07965404ULL,
+    0xd7e77a8f87daf7fbULL, 0xdc33745ec97be906ULL, 0x86f0ac99b4e8dafdULL, 0x69a028bb3ded71a3ULL,
+    0xa8acd7c0222311bcULL, 0xc40832ea0d68ce0cULL, 0xd2d80db02aabd62bULL, 0xf50a3fa490c30190ULL,
+    0x83c7088e1aab65dbULL, 0x792667c6da79e0faULL, 0xa4b8cab1a1563f52ULL, 0x577001b891185938ULL,
+    0xcde6fd5e09abcf26ULL, 0xed4c0226b55e6f86ULL, 0x80b05e5ac60b6178ULL, 0x544f8158315b05b4ULL,
+    0xa0dc75f1778e39d6ULL, 0x696361ae3db1c721ULL, 0xc913936dd571c84cULL, 0x03bc3a19cd1e38e9ULL,
+    0xfb5878494ace3a5fULL, 0x04ab48a04065c723ULL, 0x9d174b2dcec0e47bULL, 0x62eb0d64283f9c76ULL,
+    0xc45d1df942711d9aULL, 0x3ba5d0bd324f8394ULL, 0xf5746577930d6500ULL, 0xca8f44ec7ee36479ULL,
+    0x9968bf6abbe85f20ULL, 0x7e998b13cf4e1ecbULL, 0xbfc2ef456ae276e8ULL, 0x9e3fedd8c321a67eULL,
+    0xefb3ab16c59b14a2ULL, 0xc5cfe94ef3ea101eULL, 0x95d04aee3b80ece5ULL, 0xbba1f1d158724a12ULL,
+    0xbb445da9ca61281fULL, 0x2a8a6e45ae8edc97ULL, 0xea1575143cf97226ULL, 0xf52d09d71a3293bdULL,
+    0x924d692ca61be758ULL, 0x593c2626705f9c56ULL, 0xb6e0c377cfa2e12eULL, 0x6f8b2fb00c77836cULL,
+    0xe498f455c38b997aULL, 0x0b6dfb9c0f956447ULL, 0x8edf98b59a373fecULL, 0x4724bd4189bd5eacULL,
+    0xb2977ee300c50fe7ULL, 0x58edec91ec2cb657ULL, 0xdf3d5e9bc0f653e1ULL, 0x2f2967b66737e3edULL,
+    0x8b865b215899f46cULL, 0xbd79e0d20082ee74ULL, 0xae67f1e9aec07187ULL, 0xecd8590680a3aa11ULL,
+    0xda01ee641a708de9ULL, 0xe80e6f4820cc9495ULL, 0x884134fe908658b2ULL, 0x3109058d147fdcddULL,
+    0xaa51823e34a7eedeULL, 0xbd4b46f0599fd415ULL, 0xd4e5e2cdc1d1ea96ULL, 0x6c9e18ac7007c91aULL,
+    0x850fadc09923329eULL, 0x03e2cf6bc604ddb0ULL, 0xa6539930bf6bff45ULL, 0x84db8346b786151cULL,
+    0xcfe87f7cef46ff16ULL, 0xe612641865679a63ULL, 0x81f14fae158c5f6eULL, 0x4fcb7e8f3f60c07eULL,
+    0xa26da3999aef7749ULL, 0xe3be5e330f38f09dULL, 0xcb090c8001ab551cULL, 0x5cadf5bfd3072cc5ULL,
+    0xfdcb4fa002162a63ULL, 0x73d9732fc7c8f7f6ULL, 0x9e9f11c4014dda7eULL, 0x2867e7fddcdd9afaULL,
+    0xc646d63501a1511dULL, 0xb281e1fd541501b8ULL, 0xf7d88bc24209a565ULL, 0x1f225a7ca91a4226ULL,
+    0x9ae757596946075fULL, 0x3375788de9b06958ULL, 0xc1a12d2fc3978937ULL, 0x0052d6b1641c83aeULL,
+    0xf209787bb47d6b84ULL, 0xc0678c5dbd23a49aULL, 0x9745eb4d50ce6332ULL, 0xf840b7ba963646e0ULL,
+    0xbd176620a501fbffULL, 0xb650e5a93bc3d898ULL, 0xec5d3fa8ce427affULL, 0xa3e51f138ab4cebeULL,
+    0x93ba47c980e98cdfULL, 0xc66f336c36b10137ULL, 0xb8a8d9bbe123f017ULL, 0xb80b0047445d4184ULL,
+    0xe6d3102ad96cec1dULL, 0xa60dc059157491e5ULL, 0x9043ea1ac7e41392ULL, 0x87c89837ad68db2fULL,
+    0xb454e4a179dd1877ULL, 0x29babe4598c311fbULL, 0xe16a1dc9d8545e94ULL, 0xf4296dd6fef3d67aULL,
+    0x8ce2529e2734bb1dULL, 0x1899e4a65f58660cULL, 0xb01ae745b101e9e4ULL, 0x5ec05dcff72e7f8fULL,
+    0xdc21a1171d42645dULL, 0x76707543f4fa1f73ULL, 0x899504ae72497ebaULL, 0x6a06494a791c53a8ULL,
+    0xabfa45da0edbde69ULL, 0x0487db9d17636892ULL, 0xd6f8d7509292d603ULL, 0x45a9d2845d3c42b6ULL,
+    0x865b86925b9bc5c2ULL, 0x0b8a2392ba45a9b2ULL, 0xa7f26836f282b732ULL, 0x8e6cac7768d7141eULL,
+    0xd1ef0244af2364ffULL, 0x3207d795430cd926ULL, 0x8335616aed761f1fULL, 0x7f44e6bd49e807b8ULL,
+    0xa402b9c5a8d3a6e7ULL, 0x5f16206c9c6209a6ULL, 0xcd036837130890a1ULL, 0x36dba887c37a8c0fULL,
+    0x802221226be55a64ULL, 0xc2494954da2c9789ULL, 0xa02aa96b06deb0fdULL, 0xf2db9baa10b7bd6cULL,
+    0xc83553c5c8965d3dULL, 0x6f92829494e5acc7ULL, 0xfa42a8b73abbf48cULL, 0xcb772339ba1f17f9ULL,
+    0x9c69a97284b578d7ULL, 0xff2a760414536efbULL, 0xc38413cf25e2d70dULL, 0xfef5138519684abaULL,
+    0xf46518c2ef5b8cd1ULL, 0x7eb258665fc25d69ULL, 0x98bf2f79d5993802ULL, 0xef2f773ffbd97a61ULL,
+    0xbeeefb584aff8603ULL, 0xaafb550ffacfd8faULL, 0xeeaaba2e5dbf6784ULL, 0x95ba2a53f983cf38ULL,
+    0x952ab45cfa97a0b2ULL, 0xdd945a747bf26183ULL, 0xba756174393d88dfULL, 0x94f971119aeef9e4ULL,
+    0xe912b9d1478ceb17ULL, 0x7a37cd5601aab85dULL, 0x91abb422ccb812eeULL, 0xac62e055c10ab33aULL,
+    0xb616a12b7fe617aaULL, 0x577b986b314d6009ULL, 0xe39c49765fdf9d94ULL, 0xed5a7e85fda0b80bULL,
+    0x8e41ade9fbebc27dULL, 0x14588f13be847307ULL, 0xb1d219647ae6b31cULL, 0x596eb2d8ae258fc8ULL,
+    0xde469fbd99a05fe3ULL, 0x6fca5f8ed9aef3bbULL, 0x8aec23d680043beeULL, 0x25de7bb9480d5854ULL,
+    0xada72ccc20054ae9ULL, 0xaf561aa79a10ae6aULL, 0xd910f7ff28069da4ULL, 0x1b2ba1518094da04ULL,
+    0x87aa9aff79042286ULL, 0x90fb44d2f05d0842ULL, 0xa99541bf57452b28ULL, 0x353a1607ac744a53ULL,
+    0xd3fa922f2d1675f2ULL, 0x42889b8997915ce8ULL, 0x847c9b5d7c2e09b7ULL, 0x69956135febada11ULL,
+    0xa59bc234db398c25ULL, 0x43fab9837e699095ULL, 0xcf02b2c21207ef2eULL, 0x94f967e45e03f4bbULL,
+    0x8161afb94b44f57dULL, 0x1d1be0eebac278f5ULL, 0xa1ba1ba79e1632dcULL, 0x6462d92a69731732ULL,
+    0xca28a291859bbf93ULL, 0x7d7b8f7503cfdcfeULL, 0xfcb2cb35e702af78ULL, 0x5cda735244c3d43eULL,
+    0x9defbf01b061adabULL, 0x3a0888136afa64a7ULL, 0xc56baec21c7a1916ULL, 0x088aaa1845b8fdd0ULL,
+    0xf6c69a72a3989f5bULL, 0x8aad549e57273d45ULL, 0x9a3c2087a63f6399ULL, 0x36ac54e2f678864bULL,
+    0xc0cb28a98fcf3c7fULL, 0x84576a1bb416a7ddULL, 0xf0fdf2d3f3c30b9fULL, 0x656d44a2a11c51d5ULL,
+    0x969eb7c47859e743ULL, 0x9f644ae5a4b1b325ULL, 0xbc4665b596706114ULL, 0x873d5d9f0dde1feeULL,
+    0xeb57ff22fc0c7959ULL, 0xa90cb506d155a7eaULL, 0x9316ff75dd87cbd8ULL, 0x09a7f12442d588f2ULL,
+    0xb7dcbf5354e9beceULL, 0x0c11ed6d538aeb2fULL, 0xe5d3ef282a242e81ULL, 0x8f1668c8a86da5faULL,
+    0x8fa475791a569d10ULL, 0xf96e017d694487bcULL, 0xb38d92d760ec4455ULL, 0x37c981dcc395a9acULL,
+    0xe070f78d3927556aULL, 0x85bbe253f47b1417ULL, 0x8c469ab843b89562ULL, 0x93956d7478ccec8eULL,
+    0xaf58416654a6babbULL, 0x387ac8d1970027b2ULL, 0xdb2e51bfe9d0696aULL, 0x06997b05fcc0319eULL,
+    0x88fcf317f22241e2ULL, 0x441fece3bdf81f03ULL, 0xab3c2fddeeaad25aULL, 0xd527e81cad7626c3ULL,
+    0xd60b3bd56a5586f1ULL, 0x8a71e223d8d3b074ULL, 0x85c7056562757456ULL, 0xf6872d5667844e49ULL,
+    0xa738c6bebb12d16cULL, 0xb428f8ac016561dbULL, 0xd106f86e69d785c7ULL, 0xe13336d701beba52ULL,
+    0x82a45b450226b39cULL, 0xecc0024661173473ULL, 0xa34d721642b06084ULL, 0x27f002d7f95d0190ULL,
+    0xcc20ce9bd35c78a5ULL, 0x31ec038df7b441f4ULL, 0xff290242c83396ceULL, 0x7e67047175a15271ULL,
+    0x9f79a169bd203e41ULL, 0x0f0062c6e984d386ULL, 0xc75809c42c684dd1ULL, 0x52c07b78a3e60868ULL,
+    0xf92e0c3537826145ULL, 0xa7709a56ccdf8a82ULL, 0x9bbcc7a142b17ccbULL, 0x88a66076400bb691ULL,
+    0xc2abf989935ddbfeULL, 0x6acff893d00ea435ULL, 0xf356f7ebf83552feULL, 0x0583f6b8c4124d43ULL,
+    0x98165af37b2153deULL, 0xc3727a337a8b704aULL, 0xbe1bf1b059e9a8d6ULL, 0x744f18c0592e4c5cULL,
+    0xeda2ee1c7064130cULL, 0x1162def06f79df73ULL, 0x9485d4d1c63e8be7ULL, 0x8addcb5645ac2ba8ULL,
+    0xb9a74a0637ce2ee1ULL, 0x6d953e2bd7173692ULL, 0xe8111c87c5c1ba99ULL, 0xc8fa8db6ccdd0437ULL,
+    0x910ab1d4db9914a0ULL, 0x1d9c9892400a22a2ULL, 0xb54d5e4a127f59c8ULL, 0x2503beb6d00cab4bULL,
+    0xe2a0b5dc971f303aULL, 0x2e44ae64840fd61dULL, 0x8da471a9de737e24ULL, 0x5ceaecfed289e5d2ULL,
+    0xb10d8e1456105dadULL, 0x7425a83e872c5f47ULL, 0xdd50f1996b947518ULL, 0xd12f124e28f77719ULL,
+    0x8a5296ffe33cc92fULL, 0x82bd6b70d99aaa6fULL, 0xace73cbfdc0bfb7bULL, 0x636cc64d1001550bULL,
+    0xd8210befd30efa5aULL, 0x3c47f7e05401aa4eULL, 0x8714a775e3e95c78ULL, 0x65acfaec34810a71ULL,
+    0xa8d9d1535ce3b396ULL, 0x7f1839a741a14d0dULL, 0xd31045a8341ca07cULL, 0x1ede48111209a050ULL,
+    0x83ea2b892091e44dULL, 0x934aed0aab460432ULL, 0xa4e4b66b68b65d60ULL, 0xf81da84d5617853fULL,
+    0xce1de40642e3f4b9ULL, 0x36251260ab9d668eULL, 0x80d2ae83e9ce78f3ULL, 0xc1d72b7c6b426019ULL,
+    0xa1075a24e4421730ULL, 0xb24cf65b8612f81fULL, 0xc94930ae1d529cfcULL, 0xdee033f26797b627ULL,
+    0xfb9b7cd9a4a7443cULL, 0x169840ef017da3b1ULL, 0x9d412e0806e88aa5ULL, 0x8e1f289560ee864eULL,
+    0xc491798a08a2ad4eULL, 0xf1a6f2bab92a27e2ULL, 0xf5b5d7ec8acb58a2ULL, 0xae10af696774b1dbULL,
+    0x9991a6f3d6bf1765ULL, 0xacca6da1e0a8ef29ULL, 0xbff610b0cc6edd3fULL, 0x17fd090a58d32af3ULL,
+    0xeff394dcff8a948eULL, 0xddfc4b4cef07f5b0ULL, 0x95f83d0a1fb69cd9ULL, 0x4abdaf101564f98eULL,
+    0xbb764c4ca7a4440fULL, 0x9d6d1ad41abe37f1ULL, 0xea53df5fd18d5513ULL, 0x84c86189216dc5edULL,
+    0x92746b9be2f8552cULL, 0x32fd3cf5b4e49bb4ULL, 0xb7118682dbb66a77ULL, 0x3fbc8c33221dc2a1ULL,
+    0xe4d5e82392a40515ULL, 0x0fabaf3feaa5334aULL, 0x8f05b1163ba6832dULL, 0x29cb4d87f2a7400eULL,
+    0xb2c71d5bca9023f8ULL, 0x743e20e9ef511012ULL, 0xdf78e4b2bd342cf6ULL, 0x914da9246b255416ULL,
+    0x8bab8eefb6409c1aULL, 0x1ad089b6c2f7548eULL, 0xae9672aba3d0c320ULL, 0xa184ac2473b529b1ULL,
+    0xda3c0f568cc4f3e8ULL, 0xc9e5d72d90a2741eULL, 0x8865899617fb1871ULL, 0x7e2fa67c7a658892ULL,
+    0xaa7eebfb9df9de8dULL, 0xddbb901b98feeab7ULL, 0xd51ea6fa85785631ULL, 0x552a74227f3ea565ULL,
+    0x8533285c936b35deULL, 0xd53a88958f87275fULL, 0xa67ff273b8460356ULL, 0x8a892abaf368f137ULL,
+    0xd01fef10a657842cULL, 0x2d2b7569b0432d85ULL, 0x8213f56a67f6b29bULL, 0x9c3b29620e29fc73ULL,
+    0xa298f2c501f45f42ULL, 0x8349f3ba91b47b8fULL, 0xcb3f2f7642717713ULL, 0x241c70a936219a73ULL,
+    0xfe0efb53d30dd4d7ULL, 0xed238cd383aa0110ULL, 0x9ec95d1463e8a506ULL, 0xf4363804324a40aaULL,
+    0xc67bb4597ce2ce48ULL, 0xb143c6053edcd0d5ULL, 0xf81aa16fdc1b81daULL, 0xdd94b7868e94050aULL,
+    0x9b10a4e5e9913128ULL, 0xca7cf2b4191c8326ULL, 0xc1d4ce1f63f57d72ULL, 0xfd1c2f611f63a3f0ULL,
+    0xf24a01a73cf2dccfULL, 0xbc633b39673c8cecULL, 0x976e41088617ca01ULL, 0xd5be0503e085d813ULL,
+    0xbd49d14aa79dbc82ULL, 0x4b2d8644d8a74e18ULL, 0xec9c459d51852ba2ULL, 0xddf8e7d60ed1219eULL,
+    0x93e1ab8252f33b45ULL, 0xcabb90e5c942b503ULL, 0xb8da1662e7b00a17ULL, 0x3d6a751f3b936243ULL,
+    0xe7109bfba19c0c9dULL, 0x0cc512670a783ad4ULL, 0x906a617d450187e2ULL, 0x27fb2b80668b24c5ULL,
+    0xb484f9dc9641e9daULL, 0xb1f9f660802dedf6ULL, 0xe1a63853bbd26451ULL, 0x5e7873f8a0396973ULL,
+    0x8d07e33455637eb2ULL, 0xdb0b487b6423e1e8ULL, 0xb049dc016abc5e5fULL, 0x91ce1a9a3d2cda62ULL,
+    0xdc5c5301c56b75f7ULL, 0x7641a140cc7810fbULL, 0x89b9b3e11b6329baULL, 0xa9e904c87fcb0a9dULL,
+    0xac2820d9623bf429ULL, 0x546345fa9fbdcd44ULL, 0xd732290fbacaf133ULL, 0xa97c177947ad4095ULL,
+    0x867f59a9d4bed6c0ULL, 0x49ed8eabcccc485dULL, 0xa81f301449ee8c70ULL, 0x5c68f256bfff5a74ULL,
+    0xd226fc195c6a2f8cULL, 0x73832eec6fff3111ULL, 0x83585d8fd9c25db7ULL, 0xc831fd53c5ff7eabULL,
+    0xa42e74f3d032f525ULL, 0xba3e7ca8b77f5e55ULL, 0xcd3a1230c43fb26fULL, 0x28ce1bd2e55f35ebULL,
+    0x80444b5e7aa7cf85ULL, 0x7980d163cf5b81b3ULL, 0xa0555e361951c366ULL, 0xd7e105bcc332621fULL,
+    0xc86ab5c39fa63440ULL, 0x8dd9472bf3fefaa7ULL, 0xfa856334878fc150ULL, 0xb14f98f6f0feb951ULL,
+    0x9c935e00d4b9d8d2ULL, 0x6ed1bf9a569f33d3ULL, 0xc3b8358109e84f07ULL, 0x0a862f80ec4700c8ULL,
+    0xf4a642e14c6262c8ULL, 0xcd27bb612758c0faULL, 0x98e7e9cccfbd7dbdULL, 0x8038d51cb897789cULL,
+    0xbf21e44003acdd2cULL, 0xe0470a63e6bd56c3ULL, 0xeeea5d5004981478ULL, 0x1858ccfce06cac74ULL,
+    0x95527a5202df0ccbULL, 0x0f37801e0c43ebc8ULL, 0xbaa718e68396cffdULL, 0xd30560258f54e6baULL,
+    0xe950df20247c83fdULL, 0x47c6b82ef32a2069ULL, 0x91d28b7416cdd27eULL, 0x4cdc331d57fa5441ULL,
+    0xb6472e511c81471dULL, 0xe0133fe4adf8e952ULL, 0xe3d8f9e563a198e5ULL, 0x58180fddd97723a6ULL,
+    0x8e679c2f5e44ff8fULL, 0x570f09eaa7ea7648ULL,
+};
+
+// multiplies two 64-bit values and returns the high 64 bits of the 128-bit product; the low 64 bits are returned in lo
+static uint64_t yaml_mul128(uint64_t a, uint64_t b, uint64_t& lo) {
+#ifdef __SIZEOF_INT128__
+    unsigned __int128 r = (unsigned __int128)a * b;
+    lo = (uint64_t)r;
+    return (uint64_t)(r >> 64);
+#else
+    uint64_t al = (uint32_t)a, ah = a >> 32;
+    uint64_t bl = (uint32_t)b, bh = b >> 32;
+    uint64_t ll = al * bl, lh = al * bh, hl = ah * bl, hh = ah * bh;
+    uint64_t mid = (ll >> 32) + (uint32_t)lh + (uint32_t)hl;
+    lo = (mid << 32) | (uint32_t)ll;
+    return hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+#endif
+}
+
+// returns the number of leading zero bits of a non-zero value
+static int yaml_clz64(uint64_t v) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_clzll(v);
+#else
+    int n = 0;
+    while (!(v & (1ULL << 63))) {
+        v <<= 1;
+        ++n;
+    }
+    return n;
+#endif
+}
+
+// converts mant * 10^exp10 to the nearest double with the Eisel-Lemire algorithm for mantissas with up to 19 digits;
+// returns false if the result is subnormal or out of range or cannot be determined from the 128-bit product
+static bool yaml_eisel_lemire(uint64_t mant, int exp10, bool neg, double& d) {
+    if (!mant || exp10 < -342 || exp10 > 308) {
+        return false;
+    }
+
+    // normalize the mantissa and multiply with the truncated power of five
+    int lz = yaml_clz64(mant);
+    mant <<= lz;
+    const uint64_t* p5 = yaml_pow5_128 + 2 * (exp10 + 342);
+    uint64_t lo;
+    uint64_t hi = yaml_mul128(mant, p5[0], lo);
+    // the bits below the 54 bits needed for the result with a rounding bit are all ones; the low half of the power
+    // can change the result
+    if ((hi & 0x1ff) == 0x1ff) {
+        uint64_t lo2;
+        uint64_t hi2 = yaml_mul128(mant, p5[1], lo2);
+        lo += hi2;
+        if (hi2 > lo) {
+            ++hi;
+        }
+        if (lo == UINT64_MAX && (hi & 0x1ff) == 0x1ff) {
+            return false;
+        }
+    }
+
+    // the product has its most significant bit in bit 63 or 62
+    int upper = (int)(hi >> 63);
+    uint64_t m = hi >> (upper + 9);
+    // binary exponent: floor(log2(10^exp10)) + 63 with the IEEE 754 bias
+    int e2 = (((152170 + 65536) * exp10) >> 16) + 63 + upper - lz + 1023;
+    if (e2 <= 0) {
+        return false;
+    }
+
+    // round to even if the value is exactly halfway between two doubles, which is only possible for small powers
+    if (lo <= 1 && exp10 >= -4 && exp10 <= 23 && (m & 3) == 1 && (m << (upper + 9)) == hi) {
+        m &= ~1ULL;
+    }
+    m += m & 1;
+    m >>= 1;
+    if (m >= (2ULL << 52)) {
+        m = 1ULL << 52;
+        ++e2;
+    }
+    if (e2 >= 0x7ff) {
+        return false;
+    }
+
+    uint64_t bits = (m & ~(1ULL << 52)) | ((uint64_t)e2 << 52) | (neg ? 1ULL << 63 : 0);
+    memcpy(&d, &bits, sizeof d);
+    return true;
+}
+
 // FIXME: this is still capable of false positives
 static QoreValue try_parse_number(const char* val, size_t len, bool no_simple_numeric = false) {
     //printd(5, "try_parse_number() val: \"%s\" len: %d\n", val, (int)len);
@@ -252,8 +1560,31 @@ static QoreValue try_parse_number(const char* val, size_t len, bool no_simple_nu
     bool dp = false;
     // plus or minus flag (for exponent)
     bool pm = false;
+    // the value of the mantissa digits; only exact if there are no more than 19 digits
+    uint64_t mant = 0;
+    // the number of mantissa digits
+    unsigned digits = 0;
+    // the number of mantissa digits after the decimal point
+    int frac = 0;
+    // the absolute value of the exponent
+    int exp_val = 0;
+    // negative exponent flag
+    bool exp_neg = false;
+    // set if the value can only be converted by q_strtod()
+    bool slow = false;
     while (*str) {
         if (isdigit(*str)) {
+            unsigned d = *str - '0';
+            if (e) {
+                // larger exponents are always converted by q_strtod()
+                if (exp_val < 10000)
+                    exp_val = exp_val * 10 + d;
+            } else {
+                if (++digits <= 19)
+                    mant = mant * 10 + d;
+                if (dp)
+                    ++frac;
+            }
             ++str;
             continue;
         }
@@ -276,40 +1607,198 @@ static QoreValue try_parse_number(const char* val, size_t len, bool no_simple_nu
         } else if ((*str == 'e' || *str == 'E') && (isdigit(*(str + 1)) || *(str + 1) == '+' || *(str + 1) == '-')) {
             if (e || pm)
                 return QoreValue();
-            e = true;
-        } else if ((*str == '+' || *str == '-') && isdigit(*(str + 1))) {
-            if (pm || !e)
+            e = true;
+        } else if ((*str == '+' || *str == '-') && isdigit(*(str + 1))) {
+            if (pm || !e)
+                return QoreValue();
+            pm = true;
+            // a sign not directly following the "e" ends the value for q_strtod()
+            if (*(str - 1) == 'e' || *(str - 1) == 'E')
+                exp_neg = (*str == '-');
+            else
+                slow = true;
+        } else
+            return QoreValue();
+        ++str;
+    }
+
+    //printd(5, "try_parse_number() od: %d len: %d val: %s\n", od, len, val);
+
+    if (od) {
+        // the integer value has already been accumulated while validating the digits
+        if (digits < 19 || (digits == 19 && mant <= (*val == '-' ? 9223372036854775808ULL : 9223372036854775807ULL))) {
+            if (no_simple_numeric)
+                return QoreValue();
+            //printd(5, "try_parse_number() returning INT\n");
+            return *val == '-' ? (int64)(0 - mant) : (int64)mant;
+        }
+        //printd(5, "try_parse_number() returning NUMBER\n");
+        // if it is an integer requiring > 64bits, use "number" if possible
+        return new QoreNumberNode(val);
+    }
+
+    if (no_simple_numeric)
+        return QoreValue();
+
+    // mantissas with up to 19 digits are exact; other values are converted by q_strtod()
+    if (!slow && digits && digits <= 19) {
+        int exp10 = (exp_neg ? -exp_val : exp_val) - frac;
+        double d;
+        if (yaml_fast_float(mant, exp10, *val == '-', d) || yaml_eisel_lemire(mant, exp10, *val == '-', d))
+            return d;
+    }
+
+    // issue #2832 do not use strtod() as it's locale-dependent
+    return q_strtod(val);
+}
+
+// character classes for untagged plain scalars
+#define QYC_DIGIT (1 << 0)
+// other characters that can appear in a numeric value
+#define QYC_NUM   (1 << 1)
+
+static unsigned char yaml_char_class[256];
+
+// target types supported when parsing with a type template, keyed by type
+typedef std::unordered_map<const QoreTypeInfo*, QoreYamlScalarType> yaml_type_map_t;
+static yaml_type_map_t yaml_type_map;
+
+// false if the QORE_YAML_GENERAL_DATES environment variable is set when the module is loaded, in which case all
+// timestamps are decoded by the general parser in parseAbsoluteDate(); used to compare both paths with the same input
+static bool yaml_fixed_dates = true;
+
+void QoreYamlParser::staticInit() {
+    yaml_fixed_dates = !getenv("QORE_YAML_GENERAL_DATES");
+
+    for (int c = '0'; c <= '9'; ++c) {
+        yaml_char_class[c] = QYC_DIGIT;
+    }
+    for (const char* p = "+-.eEnNaAiIfF@{}"; *p; ++p) {
+        yaml_char_class[(unsigned char)*p] = QYC_NUM;
+    }
+
+    yaml_type_map = {
+        {nullptr, {NT_ALL, "auto", true, false}},
+        {autoTypeInfo, {NT_ALL, "auto", true, false}},
+        {anyTypeInfo, {NT_ALL, "any", true, false}},
+        {stringTypeInfo, {NT_STRING, "string", false, false}},
+        {stringOrNothingTypeInfo, {NT_STRING, "*string", true, false}},
+        {softStringTypeInfo, {NT_STRING, "softstring", false, true}},
+        {softStringOrNothingTypeInfo, {NT_STRING, "*softstring", true, true}},
+        {bigIntTypeInfo, {NT_INT, "int", false, false}},
+        {bigIntOrNothingTypeInfo, {NT_INT, "*int", true, false}},
+        {softBigIntTypeInfo, {NT_INT, "softint", false, true}},
+        {softBigIntOrNothingTypeInfo, {NT_INT, "*softint", true, true}},
+        {floatTypeInfo, {NT_FLOAT, "float", false, false}},
+        {floatOrNothingTypeInfo, {NT_FLOAT, "*float", true, false}},
+        {softFloatTypeInfo, {NT_FLOAT, "softfloat", false, true}},
+        {softFloatOrNothingTypeInfo, {NT_FLOAT, "*softfloat", true, true}},
+        {numberTypeInfo, {NT_NUMBER, "number", false, false}},
+        {numberOrNothingTypeInfo, {NT_NUMBER, "*number", true, false}},
+        {softNumberTypeInfo, {NT_NUMBER, "softnumber", false, true}},
+        {softNumberOrNothingTypeInfo, {NT_NUMBER, "*softnumber", true, true}},
+        {boolTypeInfo, {NT_BOOLEAN, "bool", false, false}},
+        {boolOrNothingTypeInfo, {NT_BOOLEAN, "*bool", true, false}},
+        {softBoolTypeInfo, {NT_BOOLEAN, "softbool", false, true}},
+        {softBoolOrNothingTypeInfo, {NT_BOOLEAN, "*softbool", true, true}},
+        {dateTypeInfo, {NT_DATE, "date", false, false}},
+        {dateOrNothingTypeInfo, {NT_DATE, "*date", true, false}},
+        {softDateTypeInfo, {NT_DATE, "softdate", false, true}},
+        {softDateOrNothingTypeInfo, {NT_DATE, "*softdate", true, true}},
+        {binaryTypeInfo, {NT_BINARY, "binary", false, false}},
+        {binaryOrNothingTypeInfo, {NT_BINARY, "*binary", true, false}},
+        {hashTypeInfo, {NT_HASH, "hash", false, false}},
+        {hashOrNothingTypeInfo, {NT_HASH, "*hash", true, false}},
+        {autoHashTypeInfo, {NT_HASH, "hash<auto>", false, false}},
+        {autoHashOrNothingTypeInfo, {NT_HASH, "*hash<auto>", true, false}},
+        {listTypeInfo, {NT_LIST, "list", false, false}},
+        {listOrNothingTypeInfo, {NT_LIST, "*list", true, false}},
+        {autoListTypeInfo, {NT_LIST, "list<auto>", false, false}},
+        {autoListOrNothingTypeInfo, {NT_LIST, "*list<auto>", true, false}},
+    };
+}
+
+// classifies an untagged plain scalar with a single scan of the value
+QoreValue QoreYamlParser::parsePlainScalar(const char* val, size_t len) {
+    if (!len)
+        return QoreValue();
+
+    // check for keywords and date/time values by the first character
+    switch (*val) {
+        case 't':
+            if (len == 4 && !memcmp(val, "true", 4))
+                return true;
+            return new QoreStringNode(val, len, QCS_UTF8);
+
+        case 'f':
+            if (len == 5 && !memcmp(val, "false", 5))
+                return false;
+            break;
+
+        case 'n':
+            if (len == 4 && !memcmp(val, "null", 4))
+                return QoreValue();
+            break;
+
+        case '~':
+            if (len == 1)
                 return QoreValue();
-            pm = true;
-        } else
-            return QoreValue();
-        ++str;
+            return new QoreStringNode(val, len, QCS_UTF8);
+
+        case 's':
+            if (len == 7 && !memcmp(val, "sqlnull", 7))
+                return &Null;
+            return new QoreStringNode(val, len, QCS_UTF8);
+
+        case 'P':
+            // check for relative date/time values (durations)
+            if (checkDuration(val))
+                return parseDuration();
+            return new QoreStringNode(val, len, QCS_UTF8);
+
+        default:
+            // check for absolute date/time values
+            if (checkAbsoluteDate(len, val))
+                return parseAbsoluteDate();
+            break;
     }
 
-    //printd(5, "try_parse_number() od: %d len: %d val: %s\n", od, len, val);
+    // scan once, accumulating the value of decimal integers and stopping at the first character that cannot be part
+    // of a number
+    const unsigned char* p = (const unsigned char*)val;
+    const unsigned char* end = p + len;
+    bool neg = (*p == '-');
+    if (neg || *p == '+')
+        ++p;
 
-    if (od) {
-        if ((len < 19
-            || (len == 19 && !sign
-                && ((strcmp(val, "9223372036854775807") <= 0)))
-            || (len == 20 && sign
-                && ((*val == '+' && strcmp(val, "+9223372036854775807") <= 0)
-                    || (*val == '-' && strcmp(val, "-9223372036854775808") <= 0))))) {
-            if (no_simple_numeric)
-                return QoreValue();
-            int64 iv = strtoll(val, 0, 10);
-            errno = 0;
-            assert(errno != ERANGE);
-            //printd(5, "try_parse_number() returning INT\n");
-            return iv;
+    // only digits flag
+    bool od = (p != end);
+    size_t digits = 0;
+    uint64_t mag = 0;
+    for (; p < end; ++p) {
+        unsigned char c = yaml_char_class[*p];
+        if (c & QYC_DIGIT) {
+            if (od && ++digits <= 19)
+                mag = mag * 10 + (*p - '0');
+            continue;
         }
-        //printd(5, "try_parse_number() returning NUMBER\n");
-        // if it is an integer requiring > 64bits, use "number" if possible
+        if (!c)
+            return new QoreStringNode(val, len, QCS_UTF8);
+        od = false;
+    }
+
+    if (od) {
+        if (digits <= 19 && mag <= (neg ? 9223372036854775808ULL : 9223372036854775807ULL))
+            return neg ? (int64)(0 - mag) : (int64)mag;
+        // if it is an integer requiring > 64bits, use "number"
         return new QoreNumberNode(val);
     }
 
-    // issue #2832 do not use strtod() as it's locale-dependent
-    return no_simple_numeric ? QoreValue() : QoreValue(q_strtod(val));
+    QoreValue n = try_parse_number(val, len);
+    if (n)
+        return n;
+
+    return new QoreStringNode(val, len, QCS_UTF8);
 }
 
 QoreValue QoreYamlParser::parseScalar(bool favor_string) {
@@ -338,63 +1827,56 @@ QoreValue QoreYamlParser::parseScalar(bool favor_string) {
             return n ? n : new QoreStringNode(val, len, QCS_UTF8);
         }
 
-        // check for boolean values
-        if (!strcmp(val, "true"))
-            return true;
-        if (!strcmp(val, "false"))
-            return false;
-
-        // check for null
-        if (!strcmp(val, "null") || !strcmp(val, "~") || !len)
-            return QoreValue();
-
-        // check for sqlnull
-        if (!strcmp(val, "sqlnull"))
-            return &Null;
+        return parsePlainScalar(val, len);
+    }
 
-        // check for absolute date/time values
-        if (checkAbsoluteDate(len, val)) {
-            return parseAbsoluteDate();
+    const char* tag = (const char*)event.data.scalar.tag;
+    tag_map_t::const_iterator i = tag_map.find(tag);
+    if (i != tag_map.end()) {
+        switch (i->second) {
+            case QYT_TIMESTAMP:
+                return parseAbsoluteDate();
+            case QYT_BINARY:
+                return q_yaml_base64_decode(val, len, xsink);
+            case QYT_STR:
+                return new QoreStringNode(val, len, QCS_UTF8);
+            case QYT_NULL:
+                return QoreValue();
+            case QYT_BOOL:
+                return parseBool();
+            case QYT_INT:
+                return q_atoll(val);
+            case QYT_FLOAT:
+                return parseFloat(val, len);
+            case QYT_DURATION:
+                return new DateTimeNode(val);
+            case QYT_NUMBER:
+                return parseNumber(val, len);
+            case QYT_SQLNULL:
+                return &Null;
         }
+    }
 
-        // check for relative date/time values (durations)
-        if (checkDuration(val)) {
-            return parseDuration();
-        }
+    return parseCustomTag(tag, val, len);
+}
 
-        QoreValue n = try_parse_number(val, len);
-        if (n) {
-            return n;
+QoreValue QoreYamlParser::parseCustomTag(const char* tag, const char* val, size_t len) {
+    if (tag_handlers) {
+        QoreValue h = tag_handlers->getKeyValue(tag);
+        if (h) {
+            const ResolvedCallReferenceNode* code = dynamic_cast<const ResolvedCallReferenceNode*>(h.getInternalNode());
+            assert(code);
+            ReferenceHolder<QoreListNode> args(new QoreListNode(autoTypeInfo), xsink);
+            args->push(new QoreStringNode(val, len, QCS_UTF8), xsink);
+            args->push(new QoreStringNode(tag, QCS_UTF8), xsink);
+            return code->execValue(*args, xsink);
         }
-
-        return new QoreStringNode(val, len, QCS_UTF8);
     }
 
-    const char* tag = (const char*)event.data.scalar.tag;
-    // FIXME: use a map here for O(ln(n)) performance
-    if (!strcmp(tag, YAML_TIMESTAMP_TAG))
-        return parseAbsoluteDate();
-    if (!strcmp(tag, YAML_BINARY_TAG))
-        return parseBase64(val, len, xsink);
-    if (!strcmp(tag, YAML_STR_TAG))
+    if (unknown_tags_as_strings)
         return new QoreStringNode(val, len, QCS_UTF8);
-    if (!strcmp(tag, YAML_NULL_TAG))
-        return QoreValue();
-    if (!strcmp(tag, YAML_BOOL_TAG))
-        return parseBool();
-    if (!strcmp(tag, YAML_INT_TAG))
-        return q_atoll(val);
-    if (!strcmp(tag, YAML_FLOAT_TAG))
-        return parseFloat(val, len);
-    if (!strcmp(tag, QORE_YAML_DURATION_TAG))
-        return new DateTimeNode(val);
-    if (!strcmp(tag, QORE_YAML_NUMBER_TAG))
-        return parseNumber(val, len);
-    if (!strcmp(tag, QORE_YAML_SQLNULL_TAG))
-        return &Null;
 
     xsink->raiseException(QY_PARSE_ERR, "don't know how to parse scalar tag '%s'", tag);
-
     return QoreValue();
 }
 
@@ -410,16 +1892,120 @@ bool QoreYamlParser::parseBool() {
     return false;
 }
 
-// always return the date/time value in the current timezone
-static DateTimeNode* yaml_return_date(DateTimeNode* d) {
-    d->setZone(currentTZ());
+// always return the date/time value in the parser's time zone
+static DateTimeNode* yaml_return_date(DateTimeNode* d, const AbstractQoreZoneInfo* tz) {
+    d->setZone(tz);
     return d;
 }
 
+// returns the value of two decimal digits or -1 if either character is not a digit
+static inline int yaml_d2(const unsigned char* p) {
+    unsigned a = p[0] - '0';
+    unsigned b = p[1] - '0';
+    return (a > 9 || b > 9) ? -1 : (int)(a * 10 + b);
+}
+
+// returns the number of days since 1970-01-01 for the given date in the proleptic Gregorian calendar
+static int64 yaml_days_from_civil(int y, unsigned m, unsigned d) {
+    y -= m <= 2;
+    int64 era = (y >= 0 ? y : y - 399) / 400;
+    unsigned yoe = (unsigned)(y - era * 400);
+    unsigned doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + (int64)doe - 719468;
+}
+
+// decodes fixed-width ISO-8601 timestamps in a single pass and creates the value directly from the epoch offset:
+// YYYY-MM-DD[(T|t| )HH:MM:SS[.f...][[ ](Z|(+|-)HH[:MM])]], including the form written by QoreYamlEmitter
+// returns nullptr for all other forms, which are handled by parseAbsoluteDate()
+DateTimeNode* QoreYamlParser::parseFixedDate(const char* val, size_t len) const {
+    const unsigned char* p = (const unsigned char*)val;
+    if (len < 10 || p[4] != '-' || p[7] != '-')
+        return nullptr;
+
+    int yh = yaml_d2(p);
+    int yl = yaml_d2(p + 2);
+    int month = yaml_d2(p + 5);
+    int day = yaml_d2(p + 8);
+    if (yh < 0 || yl < 0 || month < 1 || month > 12 || day < 1 || day > 31)
+        return nullptr;
+
+    int64 secs = yaml_days_from_civil(yh * 100 + yl, month, day) * 86400;
+    if (len == 10)
+        return DateTimeNode::makeAbsolute(tz, secs, 0);
+
+    if (len < 19 || (p[10] != 'T' && p[10] != 't' && p[10] != ' ') || p[13] != ':' || p[16] != ':')
+        return nullptr;
+
+    int hour = yaml_d2(p + 11);
+    int minute = yaml_d2(p + 14);
+    int second = yaml_d2(p + 17);
+    if (hour < 0 || hour > 23 || minute < 0 || minute > 59 || second < 0 || second > 59)
+        return nullptr;
+    secs += hour * 3600 + minute * 60 + second;
+
+    const unsigned char* end = p + len;
+    p += 19;
+
+    int us = 0;
+    if (p < end && *p == '.') {
+        const unsigned char* f = ++p;
+        // digits after microseconds are truncated
+        for (; p < end && (unsigned)(*p - '0') <= 9; ++p) {
+            if (p - f < 6)
+                us = us * 10 + (*p - '0');
+        }
+        if (p == f)
+            return nullptr;
+        for (ptrdiff_t i = p - f; i < 6; ++i)
+            us *= 10;
+    }
+
+    if (p < end) {
+        if (*p == ' ' && ++p == end)
+            return nullptr;
+        if (*p == 'Z') {
+            if (p + 1 != end)
+                return nullptr;
+        } else if (*p == '+' || *p == '-') {
+            ptrdiff_t zlen = end - p;
+            if (zlen != 3 && (zlen != 6 || p[3] != ':'))
+                return nullptr;
+            int utc_h = yaml_d2(p + 1);
+            int utc_m = zlen == 6 ? yaml_d2(p + 4) : 0;
+            if (utc_h < 0 || utc_m < 0)
+                return nullptr;
+            int offset = utc_h * 3600 + utc_m * 60;
+            secs -= (*p == '-') ? -offset : offset;
+        } else {
+            return nullptr;
+        }
+    }
+
+    return DateTimeNode::makeAbsolute(tz, secs, us);
+}
+
+// returns the time zone for the given UTC offset in seconds east of UTC; zones are cached for the life of the parser
+const AbstractQoreZoneInfo* QoreYamlParser::getOffsetZone(int offset) {
+    zone_cache_t::const_iterator i = zone_cache.find(offset);
+    if (i != zone_cache.end())
+        return i->second;
+
+    const AbstractQoreZoneInfo* zone = findCreateOffsetZone(offset);
+    zone_cache.insert(zone_cache_t::value_type(offset, zone));
+    return zone;
+}
+
 DateTimeNode* QoreYamlParser::parseAbsoluteDate() {
     const char* val = (const char*)event.data.scalar.value;
     size_t len = event.data.scalar.length;
 
+    if (yaml_fixed_dates) {
+        DateTimeNode* d = parseFixedDate(val, len);
+        if (d)
+            return d;
+    }
+
     if (len < 8)
         return dt_err(xsink, val, invalid_date_format);
 
@@ -457,7 +2043,7 @@ DateTimeNode* QoreYamlParser::parseAbsoluteDate() {
 
     // if there is no time portion, return date in UTC
     if (!*p)
-        return yaml_return_date(DateTimeNode::makeAbsolute(0, year, month, day));
+        return yaml_return_date(DateTimeNode::makeAbsolute(0, year, month, day), tz);
 
     if (*p != ' ' && *p != 't' && *p != 'T')
         return dt_err(xsink, val, "invalid date/time separator character");
@@ -506,7 +2092,7 @@ DateTimeNode* QoreYamlParser::parseAbsoluteDate() {
     }
 
     if (!*p)
-        return yaml_return_date(DateTimeNode::makeAbsolute(0, year, month, day, hour, minute, second));
+        return yaml_return_date(DateTimeNode::makeAbsolute(0, year, month, day, hour, minute, second), tz);
 
     int us = 0;
     if (*p == '.') {
@@ -535,7 +2121,7 @@ DateTimeNode* QoreYamlParser::parseAbsoluteDate() {
     }
 
     if (!*p)
-        return yaml_return_date(DateTimeNode::makeAbsolute(0, year, month, day, hour, minute, second, us));
+        return yaml_return_date(DateTimeNode::makeAbsolute(0, year, month, day, hour, minute, second, us), tz);
 
     const AbstractQoreZoneInfo* zone = 0;
 
@@ -599,7 +2185,7 @@ DateTimeNode* QoreYamlParser::parseAbsoluteDate() {
             }
         }
 
-        zone = findCreateOffsetZone(offset * mult);
+        zone = getOffsetZone(offset * mult);
     } else {
         return dt_err(xsink, val, invalid_chars_after_time);
     }
@@ -608,7 +2194,7 @@ DateTimeNode* QoreYamlParser::parseAbsoluteDate() {
         return dt_err(xsink, val, invalid_chars_after_time);
     }
 
-    return yaml_return_date(DateTimeNode::makeAbsolute(zone, year, month, day, hour, minute, second, us));
+    return yaml_return_date(DateTimeNode::makeAbsolute(zone, year, month, day, hour, minute, second, us), tz);
 }
 
 DateTimeNode* QoreYamlParser::parseDuration() {
@@ -660,3 +2246,414 @@ bool QoreYamlParser::checkDuration(const char* val) {
 
     return true;
 }
+
+static bool yaml_untyped(const QoreTypeInfo* t) {
+    return !t || t == autoTypeInfo || t == anyTypeInfo;
+}
+
+// returns true if NOTHING can be assigned to a value of the given type
+static bool yaml_accepts_nothing(const QoreTypeInfo* t) {
+    return yaml_untyped(t) || qore_type_is_assignable_from(t, nothingTypeInfo);
+}
+
+bool QoreYamlParser::isTypedContainer(const QoreValue v) {
+    switch (v.getType()) {
+        case NT_HASH: {
+            const QoreHashNode* h = v.get<const QoreHashNode>();
+            return h->getHashDecl() || !yaml_untyped(h->getValueTypeInfo());
+        }
+
+        case NT_LIST:
+            return !yaml_untyped(v.get<const QoreListNode>()->getValueTypeInfo());
+
+        default:
+            break;
+    }
+
+    return false;
+}
+
+// returns true if the current event is an untagged plain scalar representing null
+bool QoreYamlParser::isNullScalar() const {
+    if (event.type != YAML_SCALAR_EVENT || event.data.scalar.tag || event.data.scalar.style != YAML_PLAIN_SCALAR_STYLE)
+        return false;
+
+    const char* val = (const char*)event.data.scalar.value;
+    size_t len = event.data.scalar.length;
+    return !len || (len == 1 && *val == '~') || (len == 4 && !memcmp(val, "null", 4));
+}
+
+QoreValue QoreYamlParser::getTypeTemplate(const QoreTypeInfo* type) {
+    // scalar types and untyped containers need no template
+    if (yaml_type_map.find(type) != yaml_type_map.end())
+        return QoreValue();
+
+    std::unordered_map<const QoreTypeInfo*, QoreValue>::const_iterator i = type_tmpls.find(type);
+    if (i != type_tmpls.end())
+        return i->second;
+
+    // the default value of hashdecl and typed container types is an empty value of the type
+    QoreValue v = qore_type_get_default_value(type);
+    if (!isTypedContainer(v)) {
+        v.discard(xsink);
+        v = QoreValue();
+    }
+    type_tmpls[type] = v;
+    return v;
+}
+
+// parses the current node into a value of the given type; containers are created with the type of the template
+// value, if any, and values in containers are parsed with the types and templates given by the container
+QoreValue QoreYamlParser::parseTypedNode(const QoreTypeInfo* type, const QoreValue tmpl) {
+    switch (event.type) {
+        case YAML_SCALAR_EVENT:
+        case YAML_SEQUENCE_START_EVENT:
+        case YAML_MAPPING_START_EVENT:
+            break;
+
+        case YAML_ALIAS_EVENT:
+            return parseTypedAlias(type, tmpl);
+
+        default:
+            xsink->raiseException(QY_PARSE_ERR, "unexpected event '%s' when parsing YAML document",
+                get_event_name(event.type));
+            return QoreValue();
+    }
+
+    const yaml_char_t* anchor = getEventAnchor();
+    if (!anchor)
+        return parseTypedNodeIntern(type, tmpl);
+
+    // the event is freed when the contents of a container are parsed
+    std::string name((const char*)anchor);
+    QoreValue rv = parseTypedNodeIntern(type, tmpl);
+    if (*xsink)
+        return QoreValue();
+
+    QoreValue& v = anchors[name];
+    v.discard(xsink);
+    v = rv.refSelf();
+    return rv;
+}
+
+QoreValue QoreYamlParser::parseTypedNodeIntern(const QoreTypeInfo* type, const QoreValue tmpl) {
+    if (isTypedContainer(tmpl)) {
+        if (isNullScalar()) {
+            if (yaml_accepts_nothing(type))
+                return QoreValue();
+            xsink->raiseException(QY_PARSE_ERR, "expecting a %s for a typed %s at line %d; got a null value instead",
+                tmpl.getType() == NT_HASH ? "mapping" : "sequence", tmpl.getType() == NT_HASH ? "hash" : "list",
+                (int)event.start_mark.line + 1);
+            return QoreValue();
+        }
+
+        if (tmpl.getType() == NT_HASH) {
+            if (event.type != YAML_MAPPING_START_EVENT) {
+                xsink->raiseException(QY_PARSE_ERR, "expecting a mapping for a typed hash at line %d; got '%s' event "
+                    "instead", (int)event.start_mark.line + 1, get_event_name(event.type));
+                return QoreValue();
+            }
+            return parseTypedMap(tmpl.get<const QoreHashNode>());
+        }
+
+        if (event.type != YAML_SEQUENCE_START_EVENT) {
+            xsink->raiseException(QY_PARSE_ERR, "expecting a sequence for a typed list at line %d; got '%s' event "
+                "instead", (int)event.start_mark.line + 1, get_event_name(event.type));
+            return QoreValue();
+        }
+        return parseTypedSeq(tmpl.get<const QoreListNode>());
+    }
+
+    yaml_type_map_t::const_iterator i = yaml_type_map.find(type);
+    if (i == yaml_type_map.end()) {
+        xsink->raiseException(QY_PARSE_ERR, "cannot create a value of the declared type at line %d; provide a "
+            "typed value for this position in the type template", (int)event.start_mark.line + 1);
+        return QoreValue();
+    }
+
+    const QoreYamlScalarType& st = i->second;
+    switch (st.type) {
+        case NT_ALL:
+            return parseNodeIntern(false);
+
+        case NT_HASH:
+        case NT_LIST:
+            if (st.or_nothing && isNullScalar())
+                return QoreValue();
+            if (event.type != (st.type == NT_HASH ? YAML_MAPPING_START_EVENT : YAML_SEQUENCE_START_EVENT))
+                break;
+            return parseNodeIntern(false);
+
+        default:
+            if (event.type != YAML_SCALAR_EVENT)
+                break;
+            return parseTypedScalar(st);
+    }
+
+    xsink->raiseException(QY_PARSE_ERR, "expecting a value of type '%s' at line %d; got '%s' event instead", st.name,
+        (int)event.start_mark.line + 1, get_event_name(event.type));
+    return QoreValue();
+}
+
+QoreHashNode* QoreYamlParser::parseTypedMap(const QoreHashNode* tmpl) {
+    const TypedHashDecl* hd = tmpl->getHashDecl();
+    const QoreTypeInfo* vti = tmpl->getValueTypeInfo();
+    ReferenceHolder<QoreHashNode> h(hd ? new QoreHashNode(hd, xsink) : new QoreHashNode(vti), xsink);
+    if (*xsink)
+        return nullptr;
+
+    // the template for all values of hashes without a hashdecl
+    QoreValue vtmpl;
+    if (!hd) {
+        ConstHashIterator i(*tmpl);
+        if (i.next())
+            vtmpl = i.get();
+        if (!isTypedContainer(vtmpl))
+            vtmpl = getTypeTemplate(vti);
+    }
+
+    // storage for keys, reused for all keys in the mapping
+    std::string tmp;
+    while (true) {
+        if (getEvent())
+            return nullptr;
+
+        if (event.type == YAML_MAPPING_END_EVENT)
+            break;
+
+        const char* key;
+        if (event.type == YAML_SCALAR_EVENT && !event.data.scalar.tag && !event.data.scalar.anchor) {
+            key = getKey((const char*)event.data.scalar.value, event.data.scalar.length, tmp);
+            if (!key)
+                return nullptr;
+        } else {
+            ValueHolder kv(parseNode(true), xsink);
+            if (*xsink)
+                return nullptr;
+            QoreStringValueHelper str(*kv, QCS_DEFAULT, xsink);
+            if (*xsink)
+                return nullptr;
+            tmp.assign(str->c_str(), str->size());
+            key = tmp.c_str();
+        }
+
+        const QoreTypeInfo* mti;
+        QoreValue mtmpl;
+        if (hd) {
+            const QoreExternalMemberBase* m = hd->findLocalMember(key);
+            if (!m) {
+                xsink->raiseException(QY_PARSE_ERR, "hashdecl '%s' has no member '%s' (line %d)", hd->getName(), key,
+                    (int)event.start_mark.line + 1);
+                return nullptr;
+            }
+            mti = m->getTypeInfo();
+            mtmpl = tmpl->getKeyValue(key);
+            if (!isTypedContainer(mtmpl))
+                mtmpl = getTypeTemplate(mti);
+        } else {
+            mti = vti;
+            mtmpl = vtmpl;
+        }
+
+        // get value
+        if (getEvent())
+            return nullptr;
+
+        QoreValue value = parseTypedNode(mti, mtmpl);
+        if (*xsink)
+            return nullptr;
+
+        h->setKeyValue(key, value, xsink);
+        if (*xsink)
+            return nullptr;
+    }
+
+    return h.release();
+}
+
+QoreListNode* QoreYamlParser::parseTypedSeq(const QoreListNode* tmpl) {
+    const QoreTypeInfo* vti = tmpl->getValueTypeInfo();
+    ReferenceHolder<QoreListNode> l(new QoreListNode(vti), xsink);
+
+    // the first element of the template is the template for all elements; otherwise the template is created from
+    // the declared element type
+    QoreValue etmpl = tmpl->empty() ? QoreValue() : tmpl->retrieveEntry(0);
+    if (!isTypedContainer(etmpl))
+        etmpl = getTypeTemplate(vti);
+
+    while (true) {
+        if (getEvent())
+            return nullptr;
+
+        if (event.type == YAML_SEQUENCE_END_EVENT)
+            break;
+
+        QoreValue rv = parseTypedNode(vti, etmpl);
+        if (*xsink)
+            return nullptr;
+        l->push(rv, xsink);
+    }
+
+    return l.release();
+}
+
+// resolves an alias in a typed position; the value the alias refers to must be of the declared type
+QoreValue QoreYamlParser::parseTypedAlias(const QoreTypeInfo* type, const QoreValue tmpl) {
+    ValueHolder v(parseAlias(), xsink);
+    if (*xsink)
+        return QoreValue();
+
+    if (isTypedContainer(tmpl)) {
+        bool ok;
+        if (v->isNothing()) {
+            ok = yaml_accepts_nothing(type);
+        } else if (tmpl.getType() == NT_HASH) {
+            const QoreHashNode* th = tmpl.get<const QoreHashNode>();
+            const QoreHashNode* h = v->getType() == NT_HASH ? v->get<const QoreHashNode>() : nullptr;
+            ok = h && h->getHashDecl() == th->getHashDecl()
+                && (th->getHashDecl() || h->getValueTypeInfo() == th->getValueTypeInfo());
+        } else {
+            const QoreTypeInfo* vti = tmpl.get<const QoreListNode>()->getValueTypeInfo();
+            ok = v->getType() == NT_LIST && v->get<const QoreListNode>()->getValueTypeInfo() == vti;
+        }
+        if (ok)
+            return v.release();
+
+        xsink->raiseException(QY_PARSE_ERR, "alias '*%s' at line %d refers to a value of type '%s' that does not "
+            "match the typed %s in the type template", (const char*)event.data.alias.anchor,
+            (int)event.start_mark.line + 1, v->getTypeName(), tmpl.getType() == NT_HASH ? "hash" : "list");
+        return QoreValue();
+    }
+
+    yaml_type_map_t::const_iterator i = yaml_type_map.find(type);
+    if (i == yaml_type_map.end()) {
+        xsink->raiseException(QY_PARSE_ERR, "cannot create a value of the declared type at line %d; provide a "
+            "typed value for this position in the type template", (int)event.start_mark.line + 1);
+        return QoreValue();
+    }
+
+    if (i->second.type == NT_ALL)
+        return v.release();
+    return convertTypedValue(i->second, v);
+}
+
+// resolves the current scalar against the target type; untagged scalars for string targets are never checked for
+// other types, plain decimal integers for integer targets are converted directly, and number values are created
+// from the text of the scalar
+QoreValue QoreYamlParser::parseTypedScalar(const QoreYamlScalarType& st) {
+    if (isNullScalar()) {
+        if (st.or_nothing)
+            return QoreValue();
+        xsink->raiseException(QY_PARSE_ERR, "expecting a value of type '%s' at line %d; got a null value instead",
+            st.name, (int)event.start_mark.line + 1);
+        return QoreValue();
+    }
+
+    const char* val = (const char*)event.data.scalar.value;
+    size_t len = event.data.scalar.length;
+
+    if (!event.data.scalar.tag) {
+        if (st.type == NT_STRING)
+            return new QoreStringNode(val, len, QCS_UTF8);
+
+        if (st.type == NT_INT && event.data.scalar.style == YAML_PLAIN_SCALAR_STYLE && len) {
+            const char* p = val;
+            const char* end = val + len;
+            bool neg = (*p == '-');
+            if (neg || *p == '+')
+                ++p;
+            // up to 18 digits cannot overflow
+            if (p < end && (end - p) <= 18) {
+                int64 iv = 0;
+                for (; p < end && isdigit(*p); ++p)
+                    iv = iv * 10 + (*p - '0');
+                if (p == end)
+                    return neg ? -iv : iv;
+            }
+        }
+    }
+
+    if (st.type == NT_NUMBER) {
+        bool num;
+        if (event.data.scalar.tag) {
+            tag_map_t::const_iterator i = tag_map.find((const char*)event.data.scalar.tag);
+            num = i != tag_map.end() && (i->second == QYT_INT || i->second == QYT_FLOAT || i->second == QYT_NUMBER);
+        } else {
+            num = st.soft || event.data.scalar.style == YAML_PLAIN_SCALAR_STYLE;
+        }
+        if (num) {
+            QoreNumberNode* n = yaml_make_number(val, len);
+            if (!n) {
+                xsink->raiseException(QY_PARSE_ERR, "expecting a value of type '%s' at line %d; got invalid number "
+                    "'%s' instead", st.name, (int)event.start_mark.line + 1, val);
+            }
+            return n;
+        }
+    }
+
+    ValueHolder v(parseScalar(), xsink);
+    if (*xsink)
+        return QoreValue();
+
+    return convertTypedValue(st, v);
+}
+
+// converts a parsed value to the target type
+QoreValue QoreYamlParser::convertTypedValue(const QoreYamlScalarType& st, ValueHolder& v) {
+    qore_type_t t = v->getType();
+    if (t == st.type)
+        return v.release();
+
+    if (t != NT_NOTHING && t != NT_NULL) {
+        switch (st.type) {
+            case NT_FLOAT:
+                if (t == NT_INT || st.soft)
+                    return v->getAsFloat();
+                break;
+
+            case NT_NUMBER:
+                if (t == NT_INT)
+                    return new QoreNumberNode(v->getAsBigInt());
+                if (t == NT_FLOAT)
+                    return new QoreNumberNode(v->getAsFloat());
+                if (st.soft && t == NT_STRING) {
+                    const QoreStringNode* str = v->get<const QoreStringNode>();
+                    QoreNumberNode* n = yaml_make_number(str->c_str(), str->size());
+                    if (n)
+                        return n;
+                }
+                break;
+
+            case NT_INT:
+                if (st.soft)
+                    return v->getAsBigInt();
+                break;
+
+            case NT_BOOLEAN:
+                if (st.soft)
+                    return v->getAsBool();
+                break;
+
+            case NT_STRING:
+                if (st.soft) {
+                    QoreStringValueHelper str(*v);
+                    return str.getReferencedValue();
+                }
+                break;
+
+            case NT_DATE:
+                if (st.soft && t == NT_STRING)
+                    return new DateTimeNode(v->get<const QoreStringNode>()->c_str());
+                break;
+
+            default:
+                break;
+        }
+    } else if (st.or_nothing) {
+        return QoreValue();
+    }
+
+    xsink->raiseException(QY_PARSE_ERR, "expecting a value of type '%s' at line %d; got type '%s' instead", st.name,
+        (int)event.start_mark.line + 1, v->getTypeName());
+    return QoreValue();
+}
@@ -0,0 +1,306 @@
+/* indent-tabs-mode: nil -*- */
+/*
+    yaml Qore module
+
+    Copyright (C) 2010 - 2022 Qore Technologies, s.r.o.
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "yaml-module.h"
+
+#include <string.h>
+
+#include <atomic>
+#include <thread>
+
+// returns true if the character ends an indicator at the start of a line
+static bool yaml_is_break(const char* p, const char* end) {
+    return p == end || *p == ' ' || *p == '\t' || *p == '\r' || *p == '\n';
+}
+
+// returns true if the line starts with the given three-character document marker
+static bool yaml_is_marker(const char* line, size_t len, const char* marker) {
+    return len >= 3 && !memcmp(line, marker, 3) && yaml_is_break(line + 3, line + len);
+}
+
+// returns true if the line is empty or only contains a comment
+static bool yaml_is_blank(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n'))
+        ++p;
+    return p == end || *p == '#';
+}
+
+void QoreYamlSplitter::addUnit(size_t end, std::vector<QoreYamlUnit>& units) {
+    std::string prefix;
+    if (!unit_doc_start && !directives.empty()) {
+        prefix = directives;
+        prefix += "---\n";
+    }
+    units.push_back({unit_start, end, std::move(prefix), unit_doc_start});
+    unit_start = end;
+    unit_used = unit_content = unit_doc_start = false;
+}
+
+void QoreYamlSplitter::scan(const char* data, size_t len, bool final, std::vector<QoreYamlUnit>& units) {
+    while (pos < len) {
+        const char* line = data + pos;
+        const char* nl = (const char*)memchr(line, '\n', len - pos);
+        if (!nl && !final)
+            break;
+
+        size_t line_start = pos;
+        pos = nl ? (nl - data) + 1 : len;
+        size_t line_len = pos - line_start;
+        const char* line_end = line + line_len;
+
+        if (yaml_is_marker(line, line_len, "---")) {
+            if (unit_content)
+                addUnit(line_start, units);
+            // directives can only precede the first document or follow a document end marker
+            if (in_doc)
+                directives.clear();
+            in_doc = unit_used = unit_doc_start = true;
+            if (!yaml_is_blank(line + 3, line_end))
+                unit_content = true;
+            continue;
+        }
+
+        if (yaml_is_marker(line, line_len, "...")) {
+            if (unit_used)
+                addUnit(pos, units);
+            else
+                unit_start = pos;
+            in_doc = false;
+            unit_doc_start = true;
+            directives.clear();
+            continue;
+        }
+
+        if (*line == '%' && !in_doc) {
+            directives.append(line, line_len);
+            if (!nl)
+                directives += '\n';
+            unit_used = true;
+            continue;
+        }
+
+        if (yaml_is_blank(line, line_end))
+            continue;
+
+        if (elements && *line == '-' && yaml_is_break(line + 1, line_end) && unit_content)
+            addUnit(line_start, units);
+
+        in_doc = unit_used = unit_content = true;
+    }
+
+    if (final) {
+        if (unit_used)
+            addUnit(len, units);
+        else
+            unit_start = len;
+    }
+}
+
+int q_yaml_parse_unit(const char* data, size_t len, const std::string& prefix, bool elements,
+        const QoreHashNode* opts, anchor_value_map_t* anchors, QoreListNode& rv, ExceptionSink* xsink,
+        const AbstractQoreZoneInfo* tz) {
+    std::string tmp;
+    if (!prefix.empty()) {
+        tmp = prefix;
+        tmp.append(data, len);
+        data = tmp.data();
+        len = tmp.size();
+    }
+
+    QoreYamlParser parser(data, len, xsink);
+    if (*xsink || q_yaml_set_parse_options(parser, opts, xsink))
+        return -1;
+
+    if (tz)
+        parser.setZone(tz);
+
+    if (anchors)
+        parser.swapAnchors(*anchors);
+
+    while (true) {
+        QoreValue v;
+        if (!parser.parseNextDocument(v))
+            break;
+        ValueHolder doc(v, xsink);
+
+        if (!elements) {
+            rv.push(doc.release(), xsink);
+            continue;
+        }
+
+        // an empty document has no elements
+        if (v.isNothing())
+            continue;
+
+        if (v.getType() != NT_LIST) {
+            xsink->raiseException(QY_PARSE_ERR, "expecting a sequence as the document root when splitting root "
+                "sequence elements; got type '%s' instead", v.getTypeName());
+            break;
+        }
+
+        ConstListIterator i(*v.get<const QoreListNode>());
+        while (i.next())
+            rv.push(i.getValue().refSelf(), xsink);
+    }
+
+    if (anchors)
+        parser.swapAnchors(*anchors);
+
+    if (!*xsink)
+        return 0;
+    if (parser.limitExceeded())
+        return -2;
+    return parser.inputEnded() ? -3 : -1;
+}
+
+namespace {
+// state shared by the threads parsing units in parallel
+class QoreYamlParallelParse {
+public:
+    DLLLOCAL QoreYamlParallelParse(const char* data, const std::vector<QoreYamlUnit>& units, bool elements,
+            const QoreHashNode* opts) : data(data), units(units), elements(elements), opts(opts),
+            results(units.size(), nullptr) {
+    }
+
+    DLLLOCAL ~QoreYamlParallelParse() {
+        assert(!running);
+    }
+
+    //! parses units until there are no more units or a unit cannot be parsed
+    DLLLOCAL void work() {
+        while (!stop) {
+            size_t i = next++;
+            if (i >= units.size())
+                break;
+
+            const QoreYamlUnit& u = units[i];
+            ExceptionSink xs;
+            ReferenceHolder<QoreListNode> l(new QoreListNode(autoTypeInfo), &xs);
+            if (q_yaml_parse_unit(data + u.start, u.end - u.start, u.prefix, elements, opts, nullptr, **l, &xs, tz)) {
+                l = nullptr;
+                AutoLocker al(m);
+                // units are taken in order, so all units before the first failed unit have been parsed
+                if (i < fail_idx) {
+                    fail_idx = i;
+                    fail_xsink.clear();
+                    fail_xsink.assimilate(xs);
+                } else {
+                    xs.clear();
+                }
+                stop = true;
+                break;
+            }
+            results[i] = l.release();
+        }
+    }
+
+    //! parses with the given number of threads including the calling thread and returns the values in order
+    DLLLOCAL QoreListNode* run(unsigned threads, ExceptionSink* xsink) {
+        running = threads - 1;
+        for (unsigned i = 1; i < threads; ++i) {
+            ExceptionSink xs;
+            // q_start_thread() returns the TID of the new thread or -1 if it could not be started
+            if (q_start_thread(&xs, parse_thread, this) == -1) {
+                // continue with the threads already started if no more threads can be started
+                xs.clear();
+                AutoLocker al(m);
+                --running;
+            }
+        }
+
+        work();
+
+        {
+            AutoLocker al(m);
+            while (running)
+                cond.wait(&m);
+        }
+
+        ReferenceHolder<QoreListNode> rv(new QoreListNode(autoTypeInfo), xsink);
+        for (auto& l : results) {
+            if (!l)
+                continue;
+            if (!fail_xsink) {
+                ConstListIterator i(*l);
+                while (i.next())
+                    rv->push(i.getValue().refSelf(), xsink);
+            }
+            l->deref(xsink);
+            l = nullptr;
+        }
+
+        if (fail_xsink) {
+            xsink->assimilate(fail_xsink);
+            return nullptr;
+        }
+
+        return rv.release();
+    }
+
+private:
+    const char* data;
+    const std::vector<QoreYamlUnit>& units;
+    bool elements;
+    const QoreHashNode* opts;
+    // date/time values are returned in the time zone of the calling thread
+    const AbstractQoreZoneInfo* tz = currentTZ();
+
+    // the values of each unit
+    std::vector<QoreListNode*> results;
+    // the next unit to parse
+    std::atomic<size_t> next{0};
+    // set when a unit cannot be parsed
+    std::atomic<bool> stop{false};
+
+    QoreThreadLock m;
+    QoreCondition cond;
+    // the number of background threads still running
+    unsigned running = 0;
+    // the index and exceptions of the first unit that could not be parsed
+    size_t fail_idx = (size_t)-1;
+    ExceptionSink fail_xsink;
+
+    DLLLOCAL static void parse_thread(ExceptionSink* xsink, void* arg) {
+        QoreYamlParallelParse* pp = reinterpret_cast<QoreYamlParallelParse*>(arg);
+        pp->work();
+
+        AutoLocker al(pp->m);
+        if (!--pp->running)
+            pp->cond.signal();
+    }
+};
+}
+
+QoreListNode* q_yaml_parse_units(const char* data, const std::vector<QoreYamlUnit>& units, bool elements,
+        const QoreHashNode* opts, unsigned threads, ExceptionSink* xsink) {
+    if (!threads) {
+        threads = std::thread::hardware_concurrency();
+        if (!threads)
+            threads = 1;
+    }
+    if (threads > units.size())
+        threads = units.size();
+    if (!threads || (opts && opts->existsKey("tag_handlers")))
+        threads = 1;
+
+    QoreYamlParallelParse pp(data, units, elements, opts);
+    return pp.run(threads, xsink);
+}
@@ -1,4 +1,12 @@
 #include "yaml-module.cpp"
 #include "QoreYamlEmitter.cpp"
+#include "QoreYamlNativeEmitter.cpp"
 #include "QoreYamlParser.cpp"
+#include "QoreYamlFastParser.cpp"
+#include "QoreYamlSplitter.cpp"
+#include "QoreYamlBase64.cpp"
 #include "ql_yaml.cpp"
+#include "QC_YamlDocumentReader.cpp"
+#include "QC_YamlEventReader.cpp"
+#include "QC_YamlPushParser.cpp"
+#include "QC_YamlStreamWriter.cpp"
@@ -20,6 +20,10 @@
 */
 
 #include "yaml-module.h"
+#include "QC_YamlDocumentReader.h"
+#include "QC_YamlEventReader.h"
+#include "QC_YamlPushParser.h"
+#include "QC_YamlStreamWriter.h"
 
 static QoreStringNode *yaml_module_init();
 static void yaml_module_ns_init(QoreNamespace *rns, QoreNamespace *qns);
@@ -55,6 +59,9 @@ yaml_version_directive_t yaml_ver_1_0 = {1, 0}, yaml_ver_1_1 = {1, 1}, yaml_ver_
 // yaml event code to event string map
 event_map_t event_map;
 
+// yaml tag to native tag code map
+tag_map_t tag_map;
+
 DLLLOCAL void init_yaml_functions(QoreNamespace& ns);
 DLLLOCAL void init_yaml_constants(QoreNamespace& ns);
 
@@ -70,6 +77,11 @@ static QoreStringNode* yaml_module_init() {
     init_yaml_functions(YNS);
     // add constants
     init_yaml_constants(YNS);
+    // add classes
+    YNS.addSystemClass(initYamlDocumentReaderClass(YNS));
+    YNS.addSystemClass(initYamlEventReaderClass(YNS));
+    YNS.addSystemClass(initYamlPushParserClass(YNS));
+    YNS.addSystemClass(initYamlStreamWriterClass(YNS));
 
     // setup event map
     event_map[YAML_NO_EVENT] = "empty";
@@ -84,6 +96,20 @@ static QoreStringNode* yaml_module_init() {
     event_map[YAML_MAPPING_START_EVENT] = "mapping-start";
     event_map[YAML_MAPPING_END_EVENT] = "mapping-end";
 
+    // setup scalar tag map
+    tag_map[YAML_TIMESTAMP_TAG] = QYT_TIMESTAMP;
+    tag_map[YAML_BINARY_TAG] = QYT_BINARY;
+    tag_map[YAML_STR_TAG] = QYT_STR;
+    tag_map[YAML_NULL_TAG] = QYT_NULL;
+    tag_map[YAML_BOOL_TAG] = QYT_BOOL;
+    tag_map[YAML_INT_TAG] = QYT_INT;
+    tag_map[YAML_FLOAT_TAG] = QYT_FLOAT;
+    tag_map[QORE_YAML_DURATION_TAG] = QYT_DURATION;
+    tag_map[QORE_YAML_NUMBER_TAG] = QYT_NUMBER;
+    tag_map[QORE_YAML_SQLNULL_TAG] = QYT_SQLNULL;
+
+    QoreYamlParser::staticInit();
+
     return 0;
 }
 
@@ -29,12 +29,19 @@
 #endif
 
 #include <qore/Qore.h>
+#include <qore/InputStream.h>
+#include <qore/OutputStream.h>
 
 #include <yaml.h>
 
 #include <stdarg.h>
+#include <string.h>
 
+#include <deque>
 #include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 #define QYE_NONE                0
 #define QYE_CANONICAL           (1 << 0)
@@ -46,6 +53,8 @@
 #define QYE_VER_1_1             (1 << 6)
 #define QYE_VER_1_2             (1 << 7)
 #define QYE_EMIT_SQLNULL        (1 << 8)
+#define QYE_EMIT_ALIASES        (1 << 9)
+#define QYE_LIBYAML             (1 << 10)
 
 #define QYE_DEFAULT (QYE_NONE)
 
@@ -60,6 +69,30 @@
 // maximum length of a string value in an error msg
 #define YAML_MAX_ERR_STR_LEN 40
 
+// maximum number of hash keys cached by a parser
+#define YAML_MAX_KEY_CACHE 4096
+
+// minimum input size in bytes for parsing root sequence elements in parallel
+#define YAML_PARALLEL_MIN_SIZE (64 * 1024)
+
+// approximate memory in bytes used by each value created by the parser, not including string data
+#define YAML_NODE_SIZE 64
+
+// size of the output buffer for streaming emitter output
+#define YAML_WRITE_BUFFER_SIZE (64 * 1024)
+
+// size of the output buffer of the native emitter
+#define YAML_NATIVE_BUFFER_SIZE (16 * 1024)
+
+// the size of the buffers used to format integer and float values
+#define YAML_NUMBER_BUFFER_SIZE 32
+
+// the size of the buffers used to format date/time values
+#define YAML_DATE_BUFFER_SIZE 96
+
+// maximum size in bytes of each stack and queue of a libyaml context kept for reuse by a thread
+#define YAML_CONTEXT_MAX_STACK (64 * 1024)
+
 DLLLOCAL extern const char* QORE_YAML_DURATION_TAG;
 DLLLOCAL extern const char* QORE_YAML_NUMBER_TAG;
 DLLLOCAL extern const char* QORE_YAML_SQLNULL_TAG;
@@ -78,6 +111,82 @@ DLLLOCAL extern event_map_t event_map;
 
 DLLLOCAL extern const char* get_event_name(yaml_event_type_t type);
 
+//! initializes a libyaml parser, reusing the context cached by the current thread if available
+DLLLOCAL int q_yaml_parser_acquire(yaml_parser_t& parser);
+//! resets the parser and caches it for reuse by the current thread, or frees it if it cannot be cached
+DLLLOCAL void q_yaml_parser_release(yaml_parser_t& parser);
+//! initializes a libyaml emitter, reusing the context cached by the current thread if available
+DLLLOCAL int q_yaml_emitter_acquire(yaml_emitter_t& emitter);
+//! resets the emitter and caches it for reuse by the current thread, or frees it if it cannot be cached
+DLLLOCAL void q_yaml_emitter_release(yaml_emitter_t& emitter);
+
+//! returns the allocated size in bytes of a libyaml stack or queue
+template <typename T>
+DLLLOCAL size_t q_yaml_stack_bytes(const T& s) {
+    return (const char*)s.end - (const char*)s.start;
+}
+
+//! sets the string to the base64 encoding of the data
+DLLLOCAL void q_yaml_base64_encode(const void* data, size_t len, QoreString& str);
+//! decodes base64 data from a !!binary scalar; whitespace and line breaks are ignored
+DLLLOCAL BinaryNode* q_yaml_base64_decode(const char* data, size_t len, ExceptionSink* xsink);
+
+// scalar tags with native deserialization support
+enum qore_yaml_tag_e : unsigned char {
+    QYT_TIMESTAMP,
+    QYT_BINARY,
+    QYT_STR,
+    QYT_NULL,
+    QYT_BOOL,
+    QYT_INT,
+    QYT_FLOAT,
+    QYT_DURATION,
+    QYT_NUMBER,
+    QYT_SQLNULL,
+};
+
+// FNV-1a hash for C strings
+struct qore_yaml_hash_cstr {
+    DLLLOCAL size_t operator()(const char* str) const {
+        size_t h = 2166136261u;
+        while (*str) {
+            h = (h ^ (unsigned char)*str++) * 16777619u;
+        }
+        return h;
+    }
+};
+
+struct qore_yaml_eq_cstr {
+    DLLLOCAL bool operator()(const char* s1, const char* s2) const {
+        return !strcmp(s1, s2);
+    }
+};
+
+// a UTF-8 hash key that is not owned by the reference; used to look up keys without copying them
+struct qore_yaml_key_ref {
+    const char* str;
+    size_t len;
+
+    DLLLOCAL bool operator==(const qore_yaml_key_ref& k) const {
+        return len == k.len && !memcmp(str, k.str, len);
+    }
+};
+
+// FNV-1a hash for key references
+struct qore_yaml_hash_key_ref {
+    DLLLOCAL size_t operator()(const qore_yaml_key_ref& k) const {
+        size_t h = 2166136261u;
+        for (size_t i = 0; i < k.len; ++i) {
+            h = (h ^ (unsigned char)k.str[i]) * 16777619u;
+        }
+        return h;
+    }
+};
+
+// tag string to tag code map; keys are static strings
+typedef std::unordered_map<const char*, qore_yaml_tag_e, qore_yaml_hash_cstr, qore_yaml_eq_cstr> tag_map_t;
+DLLLOCAL extern tag_map_t tag_map;
+
 class QoreYamlWriteHandler {
 public:
     DLLLOCAL QoreYamlWriteHandler() {
@@ -89,11 +198,28 @@ public:
     DLLLOCAL virtual int write(unsigned char* buffer, size_t size) = 0;
 };
 
+class QoreYamlReadHandler {
+public:
+    DLLLOCAL QoreYamlReadHandler() {
+    }
+
+    DLLLOCAL virtual ~QoreYamlReadHandler() {
+    }
+
+    //! returns 1 for success (with *size_read = 0 at EOF), 0 for errors
+    DLLLOCAL virtual int read(unsigned char* buffer, size_t size, size_t* size_read) = 0;
+};
+
 class QoreYamlBase {
 public:
     DLLLOCAL QoreYamlBase(ExceptionSink* xsink) : xsink(xsink) {
     }
 
+    //! sets the exception sink for objects used in more than one call
+    DLLLOCAL void setExceptionSink(ExceptionSink* xs) {
+        xsink = xs;
+    }
+
 protected:
     yaml_event_t event;
     ExceptionSink* xsink;
@@ -101,7 +227,118 @@ protected:
     bool valid = false;
 };
 
-class QoreYamlEmitter : public QoreYamlBase {
+// anchor info for containers that appear more than once in emitted data
+struct QoreYamlAnchor {
+    // the number of times the container appears
+    unsigned count = 1;
+    // the anchor ID, 0 = not yet emitted
+    unsigned id = 0;
+};
+
+typedef std::map<const AbstractQoreNode*, QoreYamlAnchor> anchor_map_t;
+
+//! common base class for YAML emitters
+class QoreYamlEmitterBase : public QoreYamlBase {
+public:
+    DLLLOCAL QoreYamlEmitterBase(ExceptionSink* xsink) : QoreYamlBase(xsink) {
+    }
+
+    DLLLOCAL int doScalarEmissionError(const QoreString& str, const char* tag) {
+        // issue #3394: ensure that the string is a valid UTF-8 string before including in the exception output
+        // this is just to test for valid UTF-8 data
+        ExceptionSink xsink2;
+        str.getUnicodePoint(-1, &xsink2);
+
+        QoreString val(QCS_UTF8);
+        if (xsink2) {
+            xsink2.clear();
+            val.clear();
+            size_t len = QORE_MIN(str.size(), YAML_MAX_ERR_STR_LEN);
+            val.concatHex(str.c_str(), len);
+            if (len != str.size()) {
+                val.concat("...");
+            }
+
+            return err("unknown error initializing yaml scalar output event for yaml type '%s'; value has invalid "
+                "UTF-8 encoding: '<%s>'", tag, val.c_str());
+        }
+
+        size_t len = str.length();
+        size_t orig_len = len;
+        if (len > YAML_MAX_ERR_STR_LEN) {
+            len = YAML_MAX_ERR_STR_LEN;
+        }
+
+        val.concat(str, 0, YAML_MAX_ERR_STR_LEN, &xsink2);
+        assert(!xsink2);
+        if (len != orig_len) {
+            val.concat("...");
+        }
+        return err("unknown error initializing yaml scalar output event for yaml type '%s', value '%s'", tag,
+            val.c_str());
+    }
+
+    //! formats a float value for output with the shortest digits that are parsed back as the same value
+    /** @param buf a buffer of at least YAML_NUMBER_BUFFER_SIZE bytes; the output is NUL-terminated
+
+        @return the length of the output
+    */
+    DLLLOCAL static size_t formatValue(double f, char* buf);
+
+    //! formats an integer value for output
+    /** @param buf a buffer of at least YAML_NUMBER_BUFFER_SIZE bytes; the output is NUL-terminated
+
+        @return the length of the output
+    */
+    DLLLOCAL static size_t formatValue(int64 i, char* buf);
+
+    //! formats an arbitrary-precision number for output with the \c !number tag
+    DLLLOCAL static void formatValue(const QoreNumberNode& n, QoreString& str) {
+        n.toString(str, QORE_NF_SCIENTIFIC|QORE_NF_RAW);
+        if (str == "inf")
+            str.set("@inf@n");
+        else if (str == "-inf")
+            str.set("-@inf@n");
+        else if (str == "nan")
+            str.set("@nan@n");
+        else
+            str.concat('n');
+        // append precision
+        str.sprintf("{%d}", n.getPrec());
+    }
+
+    //! formats a date/time value for output
+    /** @param buf a buffer of at least YAML_DATE_BUFFER_SIZE bytes; the output is NUL-terminated
+        @param tag returns the YAML tag for the value
+
+        @return the length of the output
+    */
+    DLLLOCAL static size_t formatValue(const DateTime& d, bool canonical, char* buf, const char*& tag);
+
+protected:
+    DLLLOCAL int err(const char* fmt, ...) {
+        QoreStringNode* desc = new QoreStringNode(QCS_UTF8);
+        while (true) {
+            va_list args;
+            va_start(args, fmt);
+            int rc = desc->vsprintf(fmt, args);
+            va_end(args);
+            if (!rc) {
+                break;
+            }
+        }
+        if (desc->strlen() > 255) {
+            desc->terminate(255);
+            desc->concat("...");
+        }
+
+        xsink->raiseException(QY_EMIT_ERR, desc);
+        valid = false;
+        return -1;
+    }
+};
+
+class QoreYamlEmitter : public QoreYamlEmitterBase {
 public:
     DLLLOCAL QoreYamlEmitter(QoreYamlWriteHandler& n_wh, int flags, int width, int indent, ExceptionSink* n_xsink);
 
@@ -110,7 +347,7 @@ public:
             docEnd();
             streamEnd();
         }
-        yaml_emitter_delete(&emitter);
+        q_yaml_emitter_release(emitter);
     }
 
     DLLLOCAL int docStart(yaml_tag_directive_t* start = nullptr, unsigned elements = 0) {
@@ -166,39 +403,12 @@ public:
         return emit("map end");
     }
 
-    DLLLOCAL int doScalarEmissionError(const QoreString& str, const char* tag) {
-        // issue #3394: ensure that the string is a valid UTF-8 string before including in the exception output
-        // this is just to test for valid UTF-8 data
-        ExceptionSink xsink2;
-        str.getUnicodePoint(-1, &xsink2);
-
-        QoreString val(QCS_UTF8);
-        if (xsink2) {
-            xsink2.clear();
-            val.clear();
-            size_t len = QORE_MIN(str.size(), YAML_MAX_ERR_STR_LEN);
-            val.concatHex(str.c_str(), len);
-            if (len != str.size()) {
-                val.concat("...");
-            }
-
-            return err("unknown error initializing yaml scalar output event for yaml type '%s'; value has invalid "
-                "UTF-8 encoding: '<%s>'", tag, val.c_str());
-        }
-
-        size_t len = str.length();
-        size_t orig_len = len;
-        if (len > YAML_MAX_ERR_STR_LEN) {
-            len = YAML_MAX_ERR_STR_LEN;
+    DLLLOCAL int emitAlias(const char* anchor) {
+        if (!yaml_alias_event_initialize(&event, (yaml_char_t*)anchor)) {
+            return err("unknown error initializing yaml alias event");
         }
 
-        val.concat(str, 0, YAML_MAX_ERR_STR_LEN, &xsink2);
-        assert(!xsink2);
-        if (len != orig_len) {
-            val.concat("...");
-        }
-        return err("unknown error initializing yaml scalar output event for yaml type '%s', value '%s'", tag,
-            val.c_str());
+        return emit("alias");
     }
 
     DLLLOCAL int emitScalar(const QoreString& value, const char* tag, const char* anchor = nullptr,
@@ -235,58 +445,40 @@ public:
     }
 
     DLLLOCAL int emitValue(int64 i) {
-        QoreString tmp(QCS_UTF8);
-        tmp.sprintf("%lld", i);
-        return emitScalar(tmp, YAML_INT_TAG);
+        char buf[YAML_NUMBER_BUFFER_SIZE];
+        formatValue(i, buf);
+        return emitScalar(buf, YAML_INT_TAG);
     }
 
     DLLLOCAL int emitValue(double f) {
-        QoreString tmp(QCS_UTF8);
-        if (((double)((int64)f)) == f)
-            tmp.sprintf("%g.0", f);
-        else {
-            tmp.sprintf("%.25g", f);
-            // apply noise reduction algorithm
-            qore_apply_rounding_heuristic(tmp, 6, 8);
-        }
-
-        if (tmp == "inf")
-            tmp.set("@inf@");
-        else if (tmp == "-inf")
-            tmp.set("-@inf@");
-        else if (tmp == "nan")
-            tmp.set("@nan@");
-
-        //printd(5, "yaml emit float: %s\n", tmp.c_str());
-        return emitScalar(tmp, YAML_FLOAT_TAG);
+        char buf[YAML_NUMBER_BUFFER_SIZE];
+        formatValue(f, buf);
+        //printd(5, "yaml emit float: %s\n", buf);
+        return emitScalar(buf, YAML_FLOAT_TAG);
     }
 
     DLLLOCAL int emitValue(const QoreNumberNode& n) {
         QoreString tmp(QCS_UTF8);
-        n.toString(tmp, QORE_NF_SCIENTIFIC|QORE_NF_RAW);
-        if (tmp == "inf")
-            tmp.set("@inf@n");
-        else if (tmp == "-inf")
-            tmp.set("-@inf@n");
-        else if (tmp == "nan")
-            tmp.set("@nan@n");
-        else
-            tmp.concat('n');
-        // append precision
-        tmp.sprintf("{%d}", n.getPrec());
+        formatValue(n, tmp);
         //printd(5, "yaml emit number: %s\n", tmp.c_str());
         // issue #2343: to avoid ambiguity with single quoted strings, we always use the tag here
         return emitScalar(tmp, QORE_YAML_NUMBER_TAG, nullptr, false, false);
     }
 
     DLLLOCAL int emitValue(bool b) {
-        QoreString tmp(QCS_UTF8);
-        tmp.sprintf("%s", b ? "true" : "false");
-        return emitScalar(tmp, YAML_BOOL_TAG);
+        return emitScalar(b ? "true" : "false", YAML_BOOL_TAG);
     }
 
     DLLLOCAL int emitValue(const QoreListNode &l) {
-        if (seqStart(block ? YAML_BLOCK_SEQUENCE_STYLE : YAML_FLOW_SEQUENCE_STYLE)) {
+        char buf[16];
+        const char* anchor = nullptr;
+        if (!anchors.empty()) {
+            int rc = checkAlias(&l, buf, anchor);
+            if (rc) {
+                return rc < 0 ? -1 : 0;
+            }
+        }
+        if (seqStart(block ? YAML_BLOCK_SEQUENCE_STYLE : YAML_FLOW_SEQUENCE_STYLE, YAML_SEQ_TAG, anchor)) {
             return -1;
         }
         ConstListIterator li(l);
@@ -299,7 +491,15 @@ public:
     }
 
     DLLLOCAL int emitValue(const QoreHashNode &h) {
-        if (mapStart(block ? YAML_BLOCK_MAPPING_STYLE : YAML_FLOW_MAPPING_STYLE)) {
+        char buf[16];
+        const char* anchor = nullptr;
+        if (!anchors.empty()) {
+            int rc = checkAlias(&h, buf, anchor);
+            if (rc) {
+                return rc < 0 ? -1 : 0;
+            }
+        }
+        if (mapStart(block ? YAML_BLOCK_MAPPING_STYLE : YAML_FLOW_MAPPING_STYLE, YAML_MAP_TAG, anchor)) {
             return -1;
         }
         ConstHashIterator hi(h);
@@ -318,12 +518,18 @@ public:
 
     DLLLOCAL int emitValue(const BinaryNode &b) {
         QoreString str(QCS_UTF8);
-        str.concatBase64(&b);
+        q_yaml_base64_encode(b.getPtr(), b.size(), str);
         return emitScalar(str, YAML_BINARY_TAG, 0, false, false, YAML_DOUBLE_QUOTED_SCALAR_STYLE);
     }
 
     DLLLOCAL int emit(const QoreValue& v);
 
+    //! emits a top-level value; containers that appear more than once are emitted as aliases if requested
+    DLLLOCAL int emitRoot(const QoreValue& v);
+
+    //! emits each element of the list as a separate document
+    DLLLOCAL int emitDocuments(const QoreListNode& l);
+
     DLLLOCAL int emitNull() {
         return emitScalar(NullStr, YAML_NULL_TAG);
     }
@@ -344,6 +550,17 @@ public:
         return block;
     }
 
+    //! ends the current document and the stream; returns 0 for OK, -1 if an exception was raised
+    DLLLOCAL int finish() {
+        valid = false;
+        return (docEnd() || streamEnd()) ? -1 : 0;
+    }
+
+    //! discards incomplete output; the document and the stream are not ended when the object is destroyed
+    DLLLOCAL void abandon() {
+        valid = false;
+    }
+
 protected:
     yaml_emitter_t emitter;
     QoreYamlWriteHandler& wh;
@@ -351,33 +568,29 @@ protected:
     bool block,
         implicit_start_doc,
         implicit_end_doc,
-        emit_sqlnull;
+        emit_sqlnull,
+        emit_aliases;
 
-    yaml_version_directive_t* yaml_ver = nullptr;
+    // containers that appear more than once in the value being emitted
+    anchor_map_t anchors;
+    // the last anchor ID assigned
+    unsigned anchor_id = 0;
 
-    DLLLOCAL int err(const char* fmt, ...) {
-        QoreStringNode* desc = new QoreStringNode(QCS_UTF8);
-        while (true) {
-            va_list args;
-            va_start(args, fmt);
-            int rc = desc->vsprintf(fmt, args);
-            va_end(args);
-            if (!rc) {
-                break;
-            }
-        }
-        if (desc->strlen() > 255) {
-            desc->terminate(255);
-            desc->concat("...");
-        }
+    //! finds containers that appear more than once in the value to be emitted
+    DLLLOCAL void scanAliases(const QoreValue& v);
 
-        xsink->raiseException(QY_EMIT_ERR, desc);
-        valid = false;
-        return -1;
-    }
+    //! returns 1 if an alias was emitted, 0 if the container must be emitted (with an anchor if set), -1 for errors
+    DLLLOCAL int checkAlias(const AbstractQoreNode* n, char* buf, const char*& anchor);
+
+    yaml_version_directive_t* yaml_ver = nullptr;
 
     DLLLOCAL int emit(const char* event_str, const char* tag = nullptr) {
         if (!yaml_emitter_emit(&emitter, &event)) {
+            // do not mask exceptions raised by the write handler
+            if (*xsink) {
+                valid = false;
+                return -1;
+            }
             if (tag) {
                 return err("error emitting yaml %s %s event", event_str, tag);
             }
@@ -404,53 +617,559 @@ protected:
     }
 };
 
-class QoreYamlStringWriteHandler : public QoreYamlWriteHandler {
-protected:
-    QoreStringNode* str;
+//! the style of a scalar written by the native emitter
+enum QoreYamlScalarStyle {
+    QYS_ANY,            //!< plain if possible, otherwise quoted as selected by libyaml
+    QYS_SINGLE_QUOTED,  //!< single-quoted
+    QYS_DOUBLE_QUOTED,  //!< double-quoted
+};
 
+//! the styles allowed for a scalar value, as determined by libyaml's scalar analysis
+struct QoreYamlScalarInfo {
+    bool multiline = false;
+    bool flow_plain_allowed = true;
+    bool block_plain_allowed = true;
+    bool single_quoted_allowed = true;
+};
+
+//! writes YAML for Qore data directly to the output buffer without creating libyaml events
+/** The output is identical to the output of QoreYamlEmitter with the same options; it follows libyaml's rules for
+    selecting scalar styles, indentation and document markers.  Output with a line width limit, canonical output,
+    version directives and aliases is only supported by QoreYamlEmitter; see supported()
+*/
+class QoreYamlNativeEmitter : public QoreYamlEmitterBase {
 public:
-    DLLLOCAL QoreYamlStringWriteHandler() : str(new QoreStringNode(QCS_UTF8)) {
+    DLLLOCAL QoreYamlNativeEmitter(QoreYamlWriteHandler& wh, int flags, int indent, ExceptionSink* xsink);
+
+    DLLLOCAL ~QoreYamlNativeEmitter() {
+        if (valid) {
+            docEnd();
+            streamEnd();
+        }
+    }
+
+    //! returns true if output with the given options can be created by this class
+    DLLLOCAL static bool supported(int flags, int width) {
+        return width < 0 && !(flags & (QYE_CANONICAL | QYE_VER_1_0 | QYE_VER_1_1 | QYE_VER_1_2 | QYE_EMIT_ALIASES
+            | QYE_LIBYAML));
+    }
+
+    //! emits a top-level value
+    DLLLOCAL int emitRoot(const QoreValue& v) {
+        setContext(true, false, false, false);
+        return emit(v);
+    }
+
+    //! emits each element of the list as a separate document
+    DLLLOCAL int emitDocuments(const QoreListNode& l);
+
+protected:
+    QoreYamlWriteHandler& wh;
+
+    // output buffer
+    char buf[YAML_NATIVE_BUFFER_SIZE];
+    size_t len = 0;
+
+    // emitter state as maintained by libyaml
+    int column = 0;
+    int indent = -1;
+    int best_indent;
+    int flow_level = 0;
+    bool whitespace = true,
+        indention = true;
+
+    // the context of the current node
+    bool root_context = false,
+        sequence_context = false,
+        mapping_context = false,
+        simple_key_context = false;
+
+    bool block,
+        unicode,
+        implicit_start_doc,
+        implicit_end_doc,
+        emit_sqlnull;
+
+    DLLLOCAL int emit(const QoreValue& v);
+
+    DLLLOCAL int emitValue(const QoreString& str);
+    DLLLOCAL int emitValue(const QoreListNode& l);
+    DLLLOCAL int emitValue(const QoreHashNode& h);
+    DLLLOCAL int emitValue(const BinaryNode& b);
+
+    DLLLOCAL void docStart(bool first = true);
+    DLLLOCAL void docEnd();
+    DLLLOCAL void streamEnd();
+
+    DLLLOCAL void setContext(bool root, bool sequence, bool mapping, bool simple_key) {
+        root_context = root;
+        sequence_context = sequence;
+        mapping_context = mapping;
+        simple_key_context = simple_key;
+    }
+
+    //! writes a scalar with the style that libyaml selects for the requested style
+    DLLLOCAL void writeScalar(const char* value, size_t size, QoreYamlScalarStyle style,
+            const char* tag_handle = nullptr, const char* tag_suffix = nullptr,
+            const QoreYamlScalarInfo* info = nullptr);
+
+    DLLLOCAL void writePlain(const char* value, size_t size);
+    DLLLOCAL void writeSingleQuoted(const char* value, size_t size);
+    DLLLOCAL void writeDoubleQuoted(const char* value, size_t size);
+    DLLLOCAL void writeTag(const char* handle, const char* suffix);
+    DLLLOCAL void writeIndicator(const char* ind, size_t size, bool need_whitespace, bool is_whitespace,
+            bool is_indention);
+    DLLLOCAL void writeIndent();
+
+    DLLLOCAL void increaseIndent(bool flow, bool indentless) {
+        if (indent < 0) {
+            indent = flow ? best_indent : 0;
+        } else if (!indentless) {
+            indent += best_indent;
+        }
+    }
+
+    //! writes the output buffer to the write handler
+    DLLLOCAL void flush();
+
+    DLLLOCAL void put(char c) {
+        if (len == YAML_NATIVE_BUFFER_SIZE) {
+            flush();
+        }
+        buf[len++] = c;
+        ++column;
     }
 
-    DLLLOCAL ~QoreYamlStringWriteHandler() {
-        if (str) {
-            str->deref();
+    DLLLOCAL void putBreak() {
+        if (len == YAML_NATIVE_BUFFER_SIZE) {
+            flush();
         }
+        buf[len++] = '\n';
+        column = 0;
     }
 
+    //! writes bytes forming the given number of characters
+    DLLLOCAL void write(const char* p, size_t size, size_t chars);
+};
+
+//! collects YAML output in a string
+/** output is first written to a buffer reused by each thread, so that small documents are created without growing
+    the string; output larger than the buffer is appended to the string directly
+*/
+class QoreYamlStringWriteHandler : public QoreYamlWriteHandler {
+protected:
+    QoreStringNode* str = nullptr;
+    // the output buffer of the current thread while it is used by this object
+    std::string buf;
+
+public:
+    DLLLOCAL QoreYamlStringWriteHandler();
+
+    DLLLOCAL ~QoreYamlStringWriteHandler();
+
     DLLLOCAL QoreStringNode* take() {
-        QoreStringNode* rv = str;
+        QoreStringNode* rv = str ? str : new QoreStringNode(buf.data(), buf.size(), QCS_UTF8);
         str = nullptr;
+        buf.clear();
         return rv;
     }
 
     DLLLOCAL int write(unsigned char* buffer, size_t size) {
-        assert(str);
+        if (!str) {
+            if (buf.size() + size <= YAML_WRITE_BUFFER_SIZE) {
+                buf.append((const char*)buffer, size);
+                return 1;
+            }
+            str = new QoreStringNode(buf.data(), buf.size(), QCS_UTF8);
+        }
         str->concat((const char*)buffer, size);
         return 1;
     }
 };
 
+//! collects YAML output in a fixed-size buffer and writes it out when the buffer is full
+class QoreYamlBufferedWriteHandler : public QoreYamlWriteHandler {
+public:
+    DLLLOCAL QoreYamlBufferedWriteHandler(ExceptionSink* xsink) : xsink(xsink) {
+        buf.reserve(YAML_WRITE_BUFFER_SIZE);
+    }
+
+    DLLLOCAL int write(unsigned char* buffer, size_t size) {
+        if (buf.size() + size > YAML_WRITE_BUFFER_SIZE) {
+            if (flush()) {
+                return 0;
+            }
+            // large blocks are written directly
+            if (size >= YAML_WRITE_BUFFER_SIZE) {
+                return writeOut((const char*)buffer, size) ? 0 : 1;
+            }
+        }
+        buf.append((const char*)buffer, size);
+        return 1;
+    }
+
+    //! sets the exception sink for objects used in more than one call
+    DLLLOCAL void setExceptionSink(ExceptionSink* xs) {
+        xsink = xs;
+    }
+
+    //! writes out any buffered output; returns 0 for OK, -1 if an exception was raised
+    DLLLOCAL int flush() {
+        if (buf.empty()) {
+            return 0;
+        }
+        int rc = writeOut(buf.data(), buf.size());
+        buf.clear();
+        return rc;
+    }
+
+protected:
+    std::string buf;
+    ExceptionSink* xsink;
+
+    //! writes output; returns 0 for OK, -1 if an exception was raised
+    DLLLOCAL virtual int writeOut(const char* data, size_t size) = 0;
+};
+
+//! writes YAML output to an OutputStream
+class QoreYamlOutputStreamWriteHandler : public QoreYamlBufferedWriteHandler {
+public:
+    //! the OutputStream is not referenced and must remain valid for the lifetime of the object
+    DLLLOCAL QoreYamlOutputStreamWriteHandler(OutputStream* os, ExceptionSink* xsink)
+            : QoreYamlBufferedWriteHandler(xsink), os(os) {
+    }
+
+protected:
+    OutputStream* os;
+
+    DLLLOCAL virtual int writeOut(const char* data, size_t size) {
+        os->write(data, size, xsink);
+        return *xsink ? -1 : 0;
+    }
+};
+
+//! reads YAML input from an InputStream
+class QoreYamlInputStreamReadHandler : public QoreYamlReadHandler {
+public:
+    //! the InputStream must be already referenced for the new object
+    DLLLOCAL QoreYamlInputStreamReadHandler(InputStream* is, ExceptionSink* xsink) : is(is), xsink(xsink) {
+    }
+
+    DLLLOCAL ~QoreYamlInputStreamReadHandler() {
+        assert(!is);
+    }
+
+    DLLLOCAL void deref(ExceptionSink* xs) {
+        if (is) {
+            is->deref(xs);
+            is = nullptr;
+        }
+    }
+
+    DLLLOCAL void setExceptionSink(ExceptionSink* xs) {
+        xsink = xs;
+    }
+
+    DLLLOCAL int read(unsigned char* buffer, size_t size, size_t* size_read) {
+        assert(is);
+        int64 rc = is->read(buffer, size, xsink);
+        if (*xsink) {
+            return 0;
+        }
+        *size_read = (size_t)rc;
+        return 1;
+    }
+
+protected:
+    InputStream* is;
+    ExceptionSink* xsink;
+};
+
+// path expression segment for selective parsing
+struct QoreYamlPathSegment {
+    enum seg_type_e : unsigned char {
+        KEY,
+        INDEX,
+        ANY,
+    };
+
+    seg_type_e type;
+    std::string key;
+    size_t index = 0;
+};
+
+typedef std::vector<QoreYamlPathSegment> yaml_path_t;
+
+// path expressions and their results for QoreYamlParser::parseSelect()
+class QoreYamlSelection {
+public:
+    DLLLOCAL QoreYamlSelection(ExceptionSink* xsink) : rv(new QoreHashNode(autoTypeInfo), xsink) {
+    }
+
+    //! parses path expressions; returns -1 if an exception was raised
+    DLLLOCAL int init(const QoreListNode& paths, ExceptionSink* xsink);
+
+    DLLLOCAL size_t size() const {
+        return paths.size();
+    }
+
+    DLLLOCAL const yaml_path_t& getPath(size_t i) const {
+        return paths[i].path;
+    }
+
+    //! adds a matching value for the given path; takes over the reference
+    DLLLOCAL void add(size_t i, QoreValue v, ExceptionSink* xsink);
+
+    //! adds all values matching the rest of the given path in a value that has already been parsed
+    DLLLOCAL void addFromValue(size_t i, size_t pos, const QoreValue& v, ExceptionSink* xsink);
+
+    DLLLOCAL QoreHashNode* takeResult() {
+        return rv.release();
+    }
+
+private:
+    struct QoreYamlPathInfo {
+        std::string name;
+        yaml_path_t path;
+        // results for paths with wildcards are returned as a list
+        QoreListNode* list = nullptr;
+    };
+
+    std::vector<QoreYamlPathInfo> paths;
+    ReferenceHolder<QoreHashNode> rv;
+};
+
+// a path that can still match at or below the current node
+struct QoreYamlSelectState {
+    // the path index
+    size_t i;
+    // the next segment to match
+    size_t pos;
+
+    DLLLOCAL QoreYamlSelectState(size_t i, size_t pos) : i(i), pos(pos) {
+    }
+};
+
+typedef std::vector<QoreYamlSelectState> yaml_select_state_t;
+
+//! describes how a scalar is created for a target type when parsing with a type template
+struct QoreYamlScalarType {
+    // the base type code of the target type, or NT_ALL if values of any type are accepted
+    qore_type_t type;
+    // the type name for error messages
+    const char* name;
+    // true if the type also accepts NOTHING
+    bool or_nothing;
+    // true if other scalar values are converted to the target type
+    bool soft;
+};
+
+//! anchored values by anchor name; each value holds a reference
+typedef std::map<std::string, QoreValue> anchor_value_map_t;
+
+//! limits for parsing untrusted input; 0 = no limit
+struct QoreYamlLimits {
+    // the approximate memory in bytes allocated for the values of a document
+    size_t max_bytes = 0;
+    // the number of scalars, aliases, sequences and mappings in a document
+    size_t max_nodes = 0;
+    // the nesting depth of sequences and mappings
+    size_t max_depth = 0;
+    // the length of a single scalar in bytes
+    size_t max_scalar_len = 0;
+
+    DLLLOCAL bool isSet() const {
+        return max_bytes || max_nodes || max_depth || max_scalar_len;
+    }
+};
+
 class QoreYamlParser : public QoreYamlBase {
 public:
     DLLLOCAL QoreYamlParser(const QoreString& str, ExceptionSink* xsink) : QoreYamlBase(xsink), discard(false) {
-        yaml_parser_initialize(&parser);
+        q_yaml_parser_acquire(parser);
         yaml_parser_set_input_string(&parser, (const unsigned char*)str.c_str(), str.strlen());
         yaml_parser_set_encoding(&parser, YAML_UTF8_ENCODING);
+        fast_data = str.c_str();
+        fast_len = str.strlen();
         valid = true;
     }
 
+    //! parses raw input bytes in place; the encoding is determined from any byte order mark (default: UTF-8)
+    /** the input must remain valid for the lifetime of the object
+    */
+    DLLLOCAL QoreYamlParser(const void* data, size_t len, ExceptionSink* xsink);
+
+    //! reads input incrementally from the read handler; the input encoding is detected by libyaml
+    DLLLOCAL QoreYamlParser(QoreYamlReadHandler& rh, ExceptionSink* xsink);
+
+    //! initializes static parser data; called when the module is initialized
+    DLLLOCAL static void staticInit();
+
+    //! parses a stream with a single document
     DLLLOCAL QoreValue parse();
 
+    //! sets a hash of tag names to call references to deserialize scalars with custom tags
+    /** the hash is not referenced and must remain valid while the parser is used
+    */
+    DLLLOCAL void setTagHandlers(const QoreHashNode* h) {
+        tag_handlers = h;
+    }
+
+    //! sets a typed hash or list whose type determines the type of the value created
+    /** the value is not referenced and must remain valid while the parser is used
+    */
+    DLLLOCAL void setTypeTemplate(QoreValue v) {
+        type_tmpl = v;
+    }
+
+    //! returns true if the value is a hash with a hashdecl or a hash or list with a declared value type
+    DLLLOCAL static bool isTypedContainer(const QoreValue v);
+
+    //! sets the time zone for date/time values; the default is the current time zone when the parser is created
+    /** used when parsing in a thread other than the one the parser was created for
+    */
+    DLLLOCAL void setZone(const AbstractQoreZoneInfo* z) {
+        tz = z;
+    }
+
+    //! exchanges the anchors of the parser with the given map
+    /** used when the root sequence elements of a document are parsed in separate parts; once called, anchors are
+        no longer cleared after each document
+    */
+    DLLLOCAL void swapAnchors(anchor_value_map_t& a) {
+        anchors.swap(a);
+        keep_anchors = true;
+    }
+
+    //! sets whether scalars with unknown tags are returned as strings instead of raising an exception
+    DLLLOCAL void setUnknownTagsAsStrings(bool b = true) {
+        unknown_tags_as_strings = b;
+    }
+
+    //! sets limits for each document parsed; a YAML-PARSER-ERROR exception is raised as soon as a limit is exceeded
+    DLLLOCAL void setLimits(const QoreYamlLimits& l) {
+        limits = l;
+        has_limits = l.isSet();
+    }
+
+    //! returns true if parsing was aborted because a limit was exceeded
+    DLLLOCAL bool limitExceeded() const {
+        return limit_exceeded;
+    }
+
+    //! returns true if libyaml could not parse the input because the input ended before the current node was complete
+    DLLLOCAL bool inputEnded() const;
+
+    //! parses a stream with a single document and returns only the values matching the given paths
+    /** values for subtrees that cannot match any path are not created
+    */
+    DLLLOCAL QoreHashNode* parseSelect(QoreYamlSelection& sel);
+
+    //! returns the next event as a hash, or nullptr at the end of the stream or if an exception was raised
+    /** scalar values are deserialized as with parse(); values used as mapping keys are returned as strings
+    */
+    DLLLOCAL QoreHashNode* parseEvent();
+
+    //! parses the next document in a multi-document stream
+    /** @return true if a document was parsed, false at the end of the stream or if an exception was raised
+    */
+    DLLLOCAL bool parseNextDocument(QoreValue& rv);
+
     DLLLOCAL ~QoreYamlParser() {
+        clearAnchors();
+        for (auto& i : type_tmpls) {
+            i.second.discard(xsink);
+        }
         discardEvent();
-        yaml_parser_delete(&parser);
+        q_yaml_parser_release(parser);
     }
 
 protected:
     yaml_parser_t parser;
     bool discard;
 
+    // optional custom scalar tag handlers
+    const QoreHashNode* tag_handlers = nullptr;
+
+    // time zone for date/time values
+    const AbstractQoreZoneInfo* tz = currentTZ();
+
+    // time zones for UTC offsets found in date/time values
+    typedef std::map<int, const AbstractQoreZoneInfo*> zone_cache_t;
+    zone_cache_t zone_cache;
+
+    // optional value giving the type of the value to create
+    QoreValue type_tmpl;
+
+    // return scalars with unknown tags as strings instead of raising an exception
+    bool unknown_tags_as_strings = false;
+
+    // anchored values in the current document; each value holds a reference
+    anchor_value_map_t anchors;
+
+    // keep anchors after each document; set when anchors are exchanged with swapAnchors()
+    bool keep_anchors = false;
+
+    // limits for each document and the running totals for the current document
+    QoreYamlLimits limits;
+    bool has_limits = false;
+    bool limit_exceeded = false;
+    size_t total_bytes = 0;
+    size_t total_nodes = 0;
+    size_t depth = 0;
+
+    // the input for parseFast() if parsing from memory
+    const char* fast_data = nullptr;
+    size_t fast_len = 0;
+
+    // hash keys converted to the default encoding, keyed by the UTF-8 key value in key_store; only used if the
+    // default encoding is not UTF-8
+    typedef std::unordered_map<qore_yaml_key_ref, std::string, qore_yaml_hash_key_ref> key_cache_t;
+    key_cache_t key_cache;
+    // the UTF-8 keys in the cache; a deque does not move its elements when new elements are added
+    std::deque<std::string> key_store;
+
+    //! returns a hash key in the default encoding for an untagged scalar key
+    DLLLOCAL const char* getKey(const char* val, size_t len, std::string& tmp);
+
+    // templates for typed hashes and lists created from their declared type; each value holds a reference
+    std::unordered_map<const QoreTypeInfo*, QoreValue> type_tmpls;
+
+    //! returns the template for values of the given type if no template value is available
+    /** @return an empty typed hash or list for hashdecl and typed container types, otherwise NOTHING
+    */
+    DLLLOCAL QoreValue getTypeTemplate(const QoreTypeInfo* type);
+
+    DLLLOCAL void clearAnchors() {
+        for (auto& i : anchors) {
+            i.second.discard(xsink);
+        }
+        anchors.clear();
+    }
+
+    // flags for multi-document parsing
+    bool stream_start = false,
+        stream_end = false;
+
+    // container context for parseEvent()
+    enum event_ctx_e : unsigned char {
+        QYEC_SEQ,
+        QYEC_MAP_KEY,
+        QYEC_MAP_VALUE,
+    };
+    std::vector<event_ctx_e> event_ctx;
+
+    //! called after a complete node has been returned by parseEvent()
+    DLLLOCAL void eventNodeDone() {
+        if (!event_ctx.empty()) {
+            if (event_ctx.back() == QYEC_MAP_KEY) {
+                event_ctx.back() = QYEC_MAP_VALUE;
+            } else if (event_ctx.back() == QYEC_MAP_VALUE) {
+                event_ctx.back() = QYEC_MAP_KEY;
+            }
+        }
+    }
+
     DLLLOCAL void discardEvent() {
         if (discard) {
             yaml_event_delete(&event);
@@ -463,18 +1182,25 @@ protected:
 
         if (!yaml_parser_parse(&parser, &event)) {
             valid = false;
-            xsink->raiseException(QY_PARSE_ERR, "getEvent: unexpected event '%s' when parsing YAML document",
-                get_event_name(event.type));
+            // do not mask exceptions raised by the read handler
+            if (!*xsink) {
+                xsink->raiseException(QY_PARSE_ERR, "getEvent: unexpected event '%s' when parsing YAML document",
+                    get_event_name(event.type));
+            }
             return -1;
         }
         //printd(5, "QoreYamlParser::getEvent() got %s event (%d)\n", get_event_name(event.type), event.type);
 
         discard = true;
-        return 0;
+        return has_limits ? checkLimits() : 0;
     }
 
+    //! updates the running totals with the current event; returns -1 if a limit has been exceeded
+    DLLLOCAL int checkLimits();
+
     DLLLOCAL int checkEvent(yaml_event_type_t type) {
         if (event.type != type) {
+            valid = false;
             xsink->raiseException(QY_PARSE_ERR, "expecting '%s' event; got '%s' event instead", get_event_name(type),
                 get_event_name(event.type));
             return -1;
@@ -493,12 +1219,132 @@ protected:
     DLLLOCAL QoreHashNode* parseMap();
     DLLLOCAL QoreValue parseScalar(bool favor_string = false);
     DLLLOCAL QoreValue parseNode(bool favor_string = false);
+    DLLLOCAL QoreValue parseNodeIntern(bool favor_string);
+    DLLLOCAL QoreValue parseAlias();
+    DLLLOCAL const yaml_char_t* getEventAnchor() const;
+    DLLLOCAL int selectNode(QoreYamlSelection& sel, const yaml_select_state_t& states);
+    DLLLOCAL int skipNode();
+    DLLLOCAL QoreValue parseTypedNode(const QoreTypeInfo* type, const QoreValue tmpl);
+    DLLLOCAL QoreValue parseTypedNodeIntern(const QoreTypeInfo* type, const QoreValue tmpl);
+    DLLLOCAL QoreHashNode* parseTypedMap(const QoreHashNode* tmpl);
+    DLLLOCAL QoreListNode* parseTypedSeq(const QoreListNode* tmpl);
+    DLLLOCAL QoreValue parseTypedAlias(const QoreTypeInfo* type, const QoreValue tmpl);
+    DLLLOCAL QoreValue parseTypedScalar(const QoreYamlScalarType& st);
+    DLLLOCAL QoreValue convertTypedValue(const QoreYamlScalarType& st, ValueHolder& v);
+    DLLLOCAL bool isNullScalar() const;
+    DLLLOCAL QoreValue parseCustomTag(const char* tag, const char* val, size_t len);
+    DLLLOCAL QoreValue parsePlainScalar(const char* val, size_t len);
     DLLLOCAL DateTimeNode* parseAbsoluteDate();
+    DLLLOCAL DateTimeNode* parseFixedDate(const char* val, size_t len) const;
+    DLLLOCAL const AbstractQoreZoneInfo* getOffsetZone(int offset);
     DLLLOCAL DateTimeNode* parseDuration();
     DLLLOCAL bool parseBool();
 
     DLLLOCAL static bool checkAbsoluteDate(size_t len, const char* val);
     DLLLOCAL static bool checkDuration(const char* val);
+
+    //! parses the input without libyaml if it only contains constructs written by make_yaml() in flow style
+    /** @return true if the input was parsed, false if it must be parsed with libyaml; no exception is raised
+    */
+    DLLLOCAL bool parseFast(QoreValue& rv);
+    DLLLOCAL bool parseFastIntern(const unsigned char* p, const unsigned char* end, QoreValue& rv);
+    DLLLOCAL const unsigned char* parseFastKey(const unsigned char* p, const unsigned char* end, std::string& buf,
+            std::string& key_tmp, const char*& key);
+    DLLLOCAL const unsigned char* parseFastScalar(const unsigned char* p, const unsigned char* end, bool flow,
+            std::string& buf, std::string& tag, QoreValue& v);
+    DLLLOCAL bool fastCount(size_t size);
 };
 
+//! a range of YAML text containing one or more complete documents or root sequence elements
+struct QoreYamlUnit {
+    // the offsets of the unit in the input
+    size_t start, end;
+    // text to prepend when parsing the unit: the directives of the document for units that do not start it
+    std::string prefix;
+    // true if the unit starts a document
+    bool doc_start;
+};
+
+//! finds the boundaries between top-level documents, or optionally root block sequence elements, in YAML text
+/** document markers at column 0 always end the current document, even inside scalars; root sequence elements at
+    column 0 can also appear in multi-line flow collections and quoted scalars, so callers must merge units that
+    cannot be parsed with the following units
+*/
+class QoreYamlSplitter {
+public:
+    DLLLOCAL QoreYamlSplitter(bool elements) : elements(elements) {
+    }
+
+    //! scans the complete lines of the input from the current position and appends the units found
+    /** if final is true, the rest of the input is scanned and the last unit is appended
+
+        the input must be UTF-8 encoded and must start at the same position on each call except as adjusted by
+        consume()
+    */
+    DLLLOCAL void scan(const char* data, size_t len, bool final, std::vector<QoreYamlUnit>& units);
+
+    //! called when the first n bytes of the input have been removed
+    DLLLOCAL void consume(size_t n) {
+        assert(n <= unit_start);
+        pos -= n;
+        unit_start -= n;
+    }
+
+private:
+    // split root sequence elements
+    bool elements;
+    // the position of the next line to scan and the start of the current unit
+    size_t pos = 0,
+        unit_start = 0;
+    // the current unit contains a document start marker, directives, or content
+    bool unit_used = false;
+    // the current unit contains content
+    bool unit_content = false;
+    // the current unit starts a document
+    bool unit_doc_start = true;
+    // a document start marker or content has been found in the current document
+    bool in_doc = false;
+    // the directives of the current document
+    std::string directives;
+
+    DLLLOCAL void addUnit(size_t end, std::vector<QoreYamlUnit>& units);
+};
+
+//! parses a unit found by QoreYamlSplitter and appends its documents, or optionally the elements of its root
+//! sequences, to rv
+/** @param anchors if not nullptr, anchors are taken from and returned to this map so that aliases can refer to
+    anchors in earlier units of the same document
+
+    @param tz if not nullptr, the time zone for date/time values
+
+    @return 0 for OK, -1 if an exception was raised, -2 if an exception was raised because a parse limit was
+    exceeded, -3 if an exception was raised because the unit ended before the current node was complete, for
+    example inside a multi-line quoted scalar
+*/
+DLLLOCAL int q_yaml_parse_unit(const char* data, size_t len, const std::string& prefix, bool elements,
+        const QoreHashNode* opts, anchor_value_map_t* anchors, QoreListNode& rv, ExceptionSink* xsink,
+        const AbstractQoreZoneInfo* tz = nullptr);
+
+//! parses units found by QoreYamlSplitter with up to the given number of threads and returns their values in order
+/** each unit is parsed independently, so aliases cannot refer to anchors in other units; if any unit cannot be
+    parsed, the exception for the first such unit in the input is raised
+
+    custom tag handlers are only called in the calling thread, so units are parsed sequentially when they are set
+
+    @param threads the maximum number of threads to use including the calling thread; 0 = the number of CPUs
+*/
+DLLLOCAL QoreListNode* q_yaml_parse_units(const char* data, const std::vector<QoreYamlUnit>& units, bool elements,
+        const QoreHashNode* opts, unsigned threads, ExceptionSink* xsink);
+
+//! applies the parse options to the parser; returns 0 for OK, -1 if an exception was raised
+DLLLOCAL int q_yaml_set_parse_options(QoreYamlParser& parser, const QoreHashNode* opts, ExceptionSink* xsink);
+
+//! checks the parse options without applying them; returns 0 for OK, -1 if an exception was raised
+DLLLOCAL int q_yaml_check_parse_options(const QoreHashNode* opts, ExceptionSink* xsink);
+
+//! parses YAML data in place and returns the value of the first document
+/** the encoding is detected from the byte order mark, if any, otherwise the data must be UTF-8
+*/
+DLLLOCAL QoreValue q_parse_yaml_raw(const void* data, size_t len, const QoreHashNode* opts, ExceptionSink* xsink);
+
 #endif